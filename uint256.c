@@ -9,8 +9,586 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <math.h>
 #include "uint256.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define UINT256_HAVE_ADDCARRY
+#endif
+
+// The hash map's control-byte scans use SSE2 wherever it's enabled,
+// including 32-bit x86 builds.
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// The structure-of-arrays kernels are compiled twice, once for the
+// baseline target and once for AVX2, and picked at run time.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define UINT256_HAVE_AVX2_DISPATCH
+#define SOA_KERNEL static inline __attribute__((always_inline))
+#else
+#define SOA_KERNEL static inline
+#endif
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+// Internally, arithmetic that benefits from wider machine words works
+// on the value as four 64-bit limbs, least significant limb first.
+
+// On little-endian hosts the eight 32-bit words already have the same
+// memory layout as the four limbs, so conversion is a plain copy.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UINT256_LIMBS_ARE_WORDS
+#endif
+
+// Convert a UInt256 value to four 64-bit limbs.
+static void uint256_to_limbs(const UInt256 *val, uint64_t limbs[4]) {
+#ifdef UINT256_LIMBS_ARE_WORDS
+  memcpy(limbs, val->data, sizeof(val->data));
+#else
+  for (int i = 0; i < 4; i++) {
+    limbs[i] = (uint64_t)val->data[2 * i] | ((uint64_t)val->data[2 * i + 1] << 32);
+  }
+#endif
+}
+
+// Convert four 64-bit limbs back to a UInt256 value.
+static UInt256 uint256_from_limbs(const uint64_t limbs[4]) {
+  UInt256 result;
+#ifdef UINT256_LIMBS_ARE_WORDS
+  memcpy(result.data, limbs, sizeof(result.data));
+#else
+  for (int i = 0; i < 4; i++) {
+    result.data[2 * i] = (uint32_t)limbs[i];
+    result.data[2 * i + 1] = (uint32_t)(limbs[i] >> 32);
+  }
+#endif
+  return result;
+}
+
+// Multiply two 64-bit values. The low 64 bits of the product are
+// returned and the high 64 bits are stored in *hi.
+static uint64_t mul_64x64(uint64_t a, uint64_t b, uint64_t *hi) {
+#ifdef __SIZEOF_INT128__
+  uint128_t product = (uint128_t)a * b;
+  *hi = (uint64_t)(product >> 64);
+  return (uint64_t)product;
+#else
+  uint64_t aLo = a & 0xFFFFFFFFU, aHi = a >> 32;
+  uint64_t bLo = b & 0xFFFFFFFFU, bHi = b >> 32;
+  uint64_t lowLow = aLo * bLo;
+  uint64_t lowHigh = aLo * bHi;
+  uint64_t highLow = aHi * bLo;
+  uint64_t highHigh = aHi * bHi;
+  uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFU) + (highLow & 0xFFFFFFFFU);
+  *hi = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+  return (middle << 32) | (lowLow & 0xFFFFFFFFU);
+#endif
+}
+
+// Divide the 128-bit value hi:lo by d, which must be greater than hi.
+// The quotient is returned and the remainder is stored in *rem.
+static uint64_t div_128_by_64(uint64_t hi, uint64_t lo, uint64_t d, uint64_t *rem) {
+#ifdef __SIZEOF_INT128__
+  uint128_t num = ((uint128_t)hi << 64) | lo;
+  *rem = (uint64_t)(num % d);
+  return (uint64_t)(num / d);
+#else
+  // Restoring shift-and-subtract division, one quotient bit per step
+  uint64_t quot = 0;
+  for (int i = 0; i < 64; i++) {
+    uint64_t topBit = hi >> 63;
+    hi = (hi << 1) | (lo >> 63);
+    lo <<= 1;
+    quot <<= 1;
+    if (topBit || hi >= d) {
+      hi -= d;
+      quot |= 1;
+    }
+  }
+  *rem = hi;
+  return quot;
+#endif
+}
+
+// Return the number of leading zero bits in a nonzero 64-bit value.
+static int clz_64(uint64_t x) {
+#if defined(__GNUC__)
+  return __builtin_clzll(x);
+#else
+  int count = 0;
+  while (!(x & 0x8000000000000000U)) {
+    x <<= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+// Count the trailing zero bits of a nonzero 64-bit value.
+static int ctz_64(uint64_t x) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  int count = 0;
+  while (!(x & 1)) {
+    x >>= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+// Count the set bits of a 64-bit value. GCC and Clang emit popcnt when
+// the target has it.
+static int popcount_64(uint64_t x) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  int count = 0;
+  for (; x != 0; x &= x - 1) {
+    count++;
+  }
+  return count;
+#endif
+}
+
+// Return the number of significant limbs in an n-limb value
+// (0 if the value is zero).
+static int limbs_count(const uint64_t *limbs, int n) {
+  while (n > 0 && limbs[n - 1] == 0) {
+    n--;
+  }
+  return n;
+}
+
+// Divide the m-limb value u by the n-limb value v using Knuth's
+// Algorithm D. Requires 1 <= n <= 4, n <= m <= 8 and v[n - 1] != 0.
+// The m - n + 1 quotient limbs are stored in quot and the n remainder
+// limbs in rem.
+static void limbs_divmod(const uint64_t *u, int m, const uint64_t *v, int n,
+                         uint64_t *quot, uint64_t *rem) {
+  if (n == 1) {
+    // Short division by a single limb
+    uint64_t remainder = 0;
+    for (int i = m - 1; i >= 0; i--) {
+      quot[i] = div_128_by_64(remainder, u[i], v[0], &remainder);
+    }
+    rem[0] = remainder;
+    return;
+  }
+
+  // Normalize so that the divisor's top limb has its high bit set,
+  // which keeps each quotient digit estimate within 2 of the true value
+  int shift = clz_64(v[n - 1]);
+  uint64_t vn[4], un[9];
+  for (int i = n - 1; i > 0; i--) {
+    vn[i] = (v[i] << shift) | (shift ? v[i - 1] >> (64 - shift) : 0);
+  }
+  vn[0] = v[0] << shift;
+  un[m] = shift ? u[m - 1] >> (64 - shift) : 0;
+  for (int i = m - 1; i > 0; i--) {
+    un[i] = (u[i] << shift) | (shift ? u[i - 1] >> (64 - shift) : 0);
+  }
+  un[0] = u[0] << shift;
+
+  for (int j = m - n; j >= 0; j--) {
+    // Estimate the quotient digit from the top two limbs of the
+    // remainder and the top limb of the divisor
+    uint64_t qhat, rhat;
+    int rhatOverflow = 0;
+    if (un[j + n] >= vn[n - 1]) {
+      qhat = UINT64_MAX;
+      rhat = un[j + n - 1] + vn[n - 1];
+      rhatOverflow = rhat < vn[n - 1];
+    } else {
+      qhat = div_128_by_64(un[j + n], un[j + n - 1], vn[n - 1], &rhat);
+    }
+    // Refine the estimate using the second limb of the divisor
+    while (!rhatOverflow) {
+      uint64_t productHi;
+      uint64_t productLo = mul_64x64(qhat, vn[n - 2], &productHi);
+      if (productHi < rhat || (productHi == rhat && productLo <= un[j + n - 2])) {
+        break;
+      }
+      qhat--;
+      rhat += vn[n - 1];
+      rhatOverflow = rhat < vn[n - 1];
+    }
+
+    // Multiply and subtract qhat * vn from the current window of un
+    uint64_t carry = 0, borrow = 0;
+    for (int i = 0; i < n; i++) {
+      uint64_t productHi;
+      uint64_t productLo = mul_64x64(qhat, vn[i], &productHi);
+      productLo += carry;
+      carry = productHi + (productLo < carry);
+      uint64_t diff = un[i + j] - productLo;
+      uint64_t nextBorrow = (un[i + j] < productLo) | (diff < borrow);
+      un[i + j] = diff - borrow;
+      borrow = nextBorrow;
+    }
+    uint64_t top = un[j + n] - carry;
+    uint64_t topBorrow = (un[j + n] < carry) | (top < borrow);
+    un[j + n] = top - borrow;
+
+    // The estimate was one too large (rare): add the divisor back
+    if (topBorrow) {
+      qhat--;
+      carry = 0;
+      for (int i = 0; i < n; i++) {
+        uint64_t sum = un[i + j] + vn[i];
+        uint64_t nextCarry = sum < vn[i];
+        sum += carry;
+        nextCarry |= sum < carry;
+        un[i + j] = sum;
+        carry = nextCarry;
+      }
+      un[j + n] += carry;
+    }
+    quot[j] = qhat;
+  }
+
+  // Undo the normalization to recover the remainder
+  for (int i = 0; i < n - 1; i++) {
+    rem[i] = (un[i] >> shift) | (shift ? un[i + 1] << (64 - shift) : 0);
+  }
+  rem[n - 1] = un[n - 1] >> shift;
+}
+
+// Multiply two 4-limb values using product scanning (Comba's method),
+// storing the low ncols limbs (at most 8) of the product in out.
+// Each column is summed into a three-limb accumulator, so every limb
+// of the output is written exactly once.
+static void limbs_mul(const uint64_t a[4], const uint64_t b[4], uint64_t *out, int ncols) {
+  uint64_t acc0 = 0, acc1 = 0, acc2 = 0;
+  for (int k = 0; k < ncols; k++) {
+    int first = k < 4 ? 0 : k - 3;
+    int last = k < 4 ? k : 3;
+    for (int i = first; i <= last; i++) {
+      uint64_t productHi;
+      uint64_t productLo = mul_64x64(a[i], b[k - i], &productHi);
+      acc0 += productLo;
+      productHi += (acc0 < productLo);  // can't overflow: productHi <= 2^64 - 2
+      acc1 += productHi;
+      acc2 += (acc1 < productHi);
+    }
+    out[k] = acc0;
+    acc0 = acc1;
+    acc1 = acc2;
+    acc2 = 0;
+  }
+}
+
+// Compute acc + a * b + *carry. The low 64 bits are returned and the
+// high 64 bits are stored in *carry. The result always fits in 128 bits.
+static uint64_t mac_64(uint64_t acc, uint64_t a, uint64_t b, uint64_t *carry) {
+  uint64_t productHi;
+  uint64_t productLo = mul_64x64(a, b, &productHi);
+  productLo += acc;
+  productHi += (productLo < acc);
+  productLo += *carry;
+  productHi += (productLo < *carry);
+  *carry = productHi;
+  return productLo;
+}
+
+// Add a + b + carryIn (carryIn is 0 or 1), returning the low 64 bits
+// and storing the carry out in *carryOut. On x86-64 this maps onto the
+// adc instruction, so a loop over limbs compiles to a straight chain.
+static inline uint64_t addcarry_64(uint64_t a, uint64_t b, uint64_t carryIn, uint64_t *carryOut) {
+#if defined(UINT256_HAVE_ADDCARRY)
+  unsigned long long sum;
+  *carryOut = _addcarry_u64((unsigned char)carryIn, a, b, &sum);
+  return sum;
+#elif defined(__GNUC__)
+  uint64_t sum;
+  uint64_t carry1 = __builtin_add_overflow(a, b, &sum);
+  uint64_t carry2 = __builtin_add_overflow(sum, carryIn, &sum);
+  *carryOut = carry1 | carry2;
+  return sum;
+#else
+  uint64_t sum = a + b;
+  uint64_t carry = sum < a;
+  sum += carryIn;
+  *carryOut = carry | (sum < carryIn);
+  return sum;
+#endif
+}
+
+// Compute a - b - borrowIn (borrowIn is 0 or 1), returning the low 64
+// bits and storing the borrow out in *borrowOut (sbb on x86-64).
+static inline uint64_t subborrow_64(uint64_t a, uint64_t b, uint64_t borrowIn, uint64_t *borrowOut) {
+#if defined(UINT256_HAVE_ADDCARRY)
+  unsigned long long diff;
+  *borrowOut = _subborrow_u64((unsigned char)borrowIn, a, b, &diff);
+  return diff;
+#elif defined(__GNUC__)
+  uint64_t diff;
+  uint64_t borrow1 = __builtin_sub_overflow(a, b, &diff);
+  uint64_t borrow2 = __builtin_sub_overflow(diff, borrowIn, &diff);
+  *borrowOut = borrow1 | borrow2;
+  return diff;
+#else
+  uint64_t diff = a - b;
+  uint64_t borrow = a < b;
+  *borrowOut = borrow | (diff < borrowIn);
+  return diff - borrowIn;
+#endif
+}
+
+// Add two 4-limb values and an incoming carry (0 or 1), storing the sum
+// in out (which may alias either input) and returning the carry out of
+// the top limb.
+static uint64_t limbs_adc(uint64_t out[4], const uint64_t a[4], const uint64_t b[4], uint64_t carry) {
+  // Written out so that the carry stays in the flags register
+  out[0] = addcarry_64(a[0], b[0], carry, &carry);
+  out[1] = addcarry_64(a[1], b[1], carry, &carry);
+  out[2] = addcarry_64(a[2], b[2], carry, &carry);
+  out[3] = addcarry_64(a[3], b[3], carry, &carry);
+  return carry;
+}
+
+// Subtract a 4-limb value and an incoming borrow (0 or 1) from another,
+// storing the difference in out (which may alias either input) and
+// returning the borrow out of the top limb.
+static uint64_t limbs_sbb(uint64_t out[4], const uint64_t a[4], const uint64_t b[4], uint64_t borrow) {
+  out[0] = subborrow_64(a[0], b[0], borrow, &borrow);
+  out[1] = subborrow_64(a[1], b[1], borrow, &borrow);
+  out[2] = subborrow_64(a[2], b[2], borrow, &borrow);
+  out[3] = subborrow_64(a[3], b[3], borrow, &borrow);
+  return borrow;
+}
+
+// Add two 4-limb values, storing the sum in out (which may alias
+// either input) and returning the carry out of the top limb.
+static uint64_t limbs_add(uint64_t out[4], const uint64_t a[4], const uint64_t b[4]) {
+  return limbs_adc(out, a, b, 0);
+}
+
+// Subtract two 4-limb values, storing the difference in out (which may
+// alias either input) and returning the borrow out of the top limb.
+static uint64_t limbs_sub(uint64_t out[4], const uint64_t a[4], const uint64_t b[4]) {
+  return limbs_sbb(out, a, b, 0);
+}
+
+// Compare two 4-limb values, returning -1, 0 or 1. A limb's result only
+// replaces the running one when the limbs differ, which compiles to
+// conditional moves rather than branches.
+static int limbs_cmp(const uint64_t a[4], const uint64_t b[4]) {
+  int result = 0;
+  for (int i = 0; i < 4; i++) {
+    int c = (a[i] > b[i]) - (a[i] < b[i]);
+    result = c != 0 ? c : result;
+  }
+  return result;
+}
+
+// Compute the full 8-limb square of a 4-limb value. The cross products
+// a[i] * a[j] (i < j) are computed once and doubled, so a square needs
+// 10 limb multiplications instead of the 16 of a general product.
+static void limbs_sqr(const uint64_t a[4], uint64_t out[8]) {
+  for (int i = 0; i < 8; i++) {
+    out[i] = 0;
+  }
+  for (int i = 0; i < 4; i++) {
+    uint64_t carry = 0;
+    for (int j = i + 1; j < 4; j++) {
+      out[i + j] = mac_64(out[i + j], a[i], a[j], &carry);
+    }
+    out[i + 4] = carry;
+  }
+
+  // Double the cross products
+  for (int i = 7; i > 0; i--) {
+    out[i] = (out[i] << 1) | (out[i - 1] >> 63);
+  }
+  out[0] <<= 1;
+
+  // Add the squares on the diagonal
+  uint64_t carry = 0;
+  for (int i = 0; i < 4; i++) {
+    uint64_t squareHi;
+    uint64_t squareLo = mul_64x64(a[i], a[i], &squareHi);
+    uint64_t sum = out[2 * i] + squareLo;
+    uint64_t nextCarry = sum < squareLo;
+    sum += carry;
+    nextCarry += sum < carry;
+    out[2 * i] = sum;
+
+    sum = out[2 * i + 1] + squareHi;
+    carry = sum < squareHi;
+    sum += nextCarry;
+    carry += sum < nextCarry;
+    out[2 * i + 1] = sum;
+  }
+}
+
+// Reduce the 8-limb value t modulo the nonzero 4-limb value mod.
+static void limbs_mod_wide(const uint64_t t[8], const uint64_t mod[4], uint64_t out[4]) {
+  uint64_t quot[8], rem[4] = {0};
+  int m = limbs_count(t, 8);
+  int n = limbs_count(mod, 4);
+  if (m < n) {
+    for (int i = 0; i < 4; i++) {
+      out[i] = t[i];
+    }
+    return;
+  }
+  limbs_divmod(t, m, mod, n, quot, rem);
+  for (int i = 0; i < 4; i++) {
+    out[i] = rem[i];
+  }
+}
+
+// Montgomery reduction (REDC): given t < mod * 2^256, compute
+// t * 2^-256 mod mod. One limb of t is cleared per step by adding a
+// multiple of mod, so no division is needed. t is overwritten.
+static void mont_reduce(const uint64_t mod[4], uint64_t n0inv, uint64_t t[8], uint64_t out[4]) {
+  uint64_t extra = 0;  // carry that has moved past the top limb of t
+  for (int i = 0; i < 4; i++) {
+    uint64_t m = t[i] * n0inv;
+    uint64_t carry = 0;
+    for (int j = 0; j < 4; j++) {
+      t[i + j] = mac_64(t[i + j], m, mod[j], &carry);
+    }
+    uint64_t sum = t[i + 4] + carry;
+    uint64_t nextExtra = sum < carry;
+    sum += extra;
+    nextExtra += sum < extra;
+    t[i + 4] = sum;
+    extra = nextExtra;
+  }
+
+  // The result is now extra:t[4..7] < 2 * mod; subtract mod once if needed
+  uint64_t diff[4];
+  uint64_t borrow = limbs_sub(diff, t + 4, mod);
+  uint64_t keepDiff = 0 - (extra | (borrow ^ 1));
+  for (int i = 0; i < 4; i++) {
+    out[i] = (diff[i] & keepDiff) | (t[i + 4] & ~keepDiff);
+  }
+}
+
+// Montgomery product of two 4-limb values that are less than mod.
+static void mont_mul_limbs(const uint64_t mod[4], uint64_t n0inv,
+                           const uint64_t a[4], const uint64_t b[4], uint64_t out[4]) {
+  uint64_t t[8];
+  limbs_mul(a, b, t, 8);
+  mont_reduce(mod, n0inv, t, out);
+}
+
+// Montgomery square of a 4-limb value that is less than mod.
+static void mont_sqr_limbs(const uint64_t mod[4], uint64_t n0inv, const uint64_t a[4], uint64_t out[4]) {
+  uint64_t t[8];
+  limbs_sqr(a, t);
+  mont_reduce(mod, n0inv, t, out);
+}
+
+// Return the number of significant bits in a 4-limb value.
+static int limbs_bit_length(const uint64_t a[4]) {
+  int n = limbs_count(a, 4);
+  return n == 0 ? 0 : 64 * n - clz_64(a[n - 1]);
+}
+
+// Return bit i of a 4-limb value.
+static unsigned limbs_bit(const uint64_t a[4], int i) {
+  return (unsigned)(a[i / 64] >> (i % 64)) & 1;
+}
+
+// Return width bits (1 to 64) of a starting at bit lo, where bits past
+// the top of a read as zero. At most two limbs are touched, joined with
+// a funnel shift.
+static uint64_t limbs_extract(const uint64_t a[4], unsigned lo, unsigned width) {
+  if (lo >= 256) {
+    return 0;
+  }
+  unsigned idx = lo / 64, shift = lo % 64;
+  uint64_t bits = a[idx] >> shift;
+  if (shift != 0 && idx < 3) {
+    bits |= a[idx + 1] << (64 - shift);
+  }
+  return width >= 64 ? bits : bits & ((UINT64_C(1) << width) - 1);
+}
+
+// Return an all-ones mask if cond is nonzero and zero otherwise,
+// without branching.
+static inline uint64_t mask_if(uint64_t cond) {
+  return 0 - (uint64_t)(cond != 0);
+}
+
+// Return x unchanged, but hide its value from the optimizer so that
+// mask arithmetic built on it can't be turned back into a branch.
+static inline uint64_t ct_barrier(uint64_t x) {
+#if defined(__GNUC__)
+  __asm__("" : "+r"(x));
+#endif
+  return x;
+}
+
+// Funnel shift: the high 64 bits of (hi:lo) << s, for 0 <= s < 64.
+// Splitting the right shift in two keeps s = 0 well defined (shld).
+static inline uint64_t funnel_left(uint64_t hi, uint64_t lo, unsigned s) {
+  return (hi << s) | ((lo >> 1) >> (63 - s));
+}
+
+// Funnel shift: the low 64 bits of (hi:lo) >> s, for 0 <= s < 64 (shrd).
+static inline uint64_t funnel_right(uint64_t hi, uint64_t lo, unsigned s) {
+  return (lo >> s) | ((hi << 1) << (63 - s));
+}
+
+// The shifts and rotates below move whole limbs by selecting among all
+// four candidates with masks, then funnel-shift the remaining bits, so
+// their instruction and memory access pattern doesn't depend on the
+// shift amount.
+
+// Rotate a 4-limb value left by nbits (0 <= nbits < 256).
+static void limbs_rotate_left(const uint64_t a[4], unsigned nbits, uint64_t out[4]) {
+  unsigned limbShift = nbits / 64, bitShift = nbits % 64;
+  uint64_t t[4];
+  for (int i = 0; i < 4; i++) {
+    t[i] = 0;
+    for (unsigned k = 0; k < 4; k++) {
+      t[i] |= a[(i - k) & 3] & mask_if(k == limbShift);
+    }
+  }
+  for (int i = 0; i < 4; i++) {
+    out[i] = funnel_left(t[i], t[(i + 3) & 3], bitShift);
+  }
+}
+
+// Shift a 4-limb value left by nbits; 256 or more gives 0.
+static void limbs_shl(const uint64_t a[4], unsigned nbits, uint64_t out[4]) {
+  unsigned limbShift = nbits / 64, bitShift = nbits % 64;
+  uint64_t t[5] = {0};  // t[0] stays zero and feeds the bottom limb
+  for (int i = 0; i < 4; i++) {
+    for (int k = 0; k <= i; k++) {
+      t[i + 1] |= a[i - k] & mask_if((unsigned)k == limbShift);
+    }
+  }
+  for (int i = 0; i < 4; i++) {
+    out[i] = funnel_left(t[i + 1], t[i], bitShift);
+  }
+}
+
+// Shift a 4-limb value right by nbits; 256 or more gives 0.
+static void limbs_shr(const uint64_t a[4], unsigned nbits, uint64_t out[4]) {
+  unsigned limbShift = nbits / 64, bitShift = nbits % 64;
+  uint64_t t[5] = {0};  // t[4] stays zero and feeds the top limb
+  for (int i = 0; i < 4; i++) {
+    for (int k = 0; i + k < 4; k++) {
+      t[i] |= a[i + k] & mask_if((unsigned)k == limbShift);
+    }
+  }
+  for (int i = 0; i < 4; i++) {
+    out[i] = funnel_right(t[i + 1], t[i], bitShift);
+  }
+}
+
 // Create a UInt256 value from a single uint32_t value.
 // Only the least-significant 32 bits are initialized directly,
 // all other bits are set to 0.
@@ -31,207 +609,2869 @@ UInt256 uint256_create(const uint32_t data[8]) {
   return result;
 }
 
-// Create a UInt256 value from a string of hexadecimal digits.
-UInt256 uint256_create_from_hex(const char *hex) {
+// Parse hex the way uint256_create_from_hex always has for input that
+// isn't plain hex: keep the last 64 characters, split them into 8-digit
+// chunks from the right, and read each chunk with strtoul, which stops
+// at the first character that isn't a digit.
+static UInt256 parse_hex_lenient(const char *hex, size_t len) {
   UInt256 result = {0};
-  if (strlen(hex) > 64) {
-    char newStr[65];
-    for (int i = 0; i < 64; i++) {
-      newStr[i] = hex[strlen(hex) - 64 + i];
-    }
-    newStr[64] = '\0';
-    hex = newStr;
+  if (len > 64) {
+    hex += len - 64;
+    len = 64;
+  }
+  for (int i = 0; len > 0; i++) {
+    size_t n = len < 8 ? len : 8;
+    char chunk[9];
+    memcpy(chunk, hex + len - n, n);
+    chunk[n] = '\0';
+    result.data[i] = (uint32_t)strtoul(chunk, NULL, 16);
+    len -= n;
   }
-  else if (strlen(hex) < 8) {
-    result.data[0] = strtoul(hex , NULL, 16);
+  return result;
+}
+
+// Create a UInt256 value from a string of hexadecimal digits. Valid
+// input takes the single-pass parser; anything else keeps the old
+// chunk-by-chunk strtoul result.
+UInt256 uint256_create_from_hex(const char *hex) {
+  size_t len = strlen(hex);
+  UInt256 result;
+  if (uint256_parse_hex(hex, len, &result) == UINT256_PARSE_OK) {
     return result;
   }
+  return parse_hex_lenient(hex, len);
+}
 
-  int len = strlen(hex);
-  int uIntIndex = 0;
-  
-    int remainder = len % 8;
-  if (remainder != 0) {
-    int lastIndex = len / 8;
-    char shortStr[remainder + 1];
-    for (int i = 0; i < remainder; i++) {
-      shortStr[i] = hex[i];
-    }
-    result.data[lastIndex] = strtoul(shortStr, NULL, 16);
+// Lowercase hex digit for each nibble value.
+static const char hexDigits[16] = "0123456789abcdef";
+
+// Value of each character as a hex digit, or 0xFF if it isn't one.
+static const uint8_t hexDigitValue[256] = {
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+     0,    1,    2,    3,    4,    5,    6,    7,    8,    9, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF,   10,   11,   12,   13,   14,   15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF,   10,   11,   12,   13,   14,   15, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+// Parse len characters of hex into *out in a single pass. Digits are
+// placed by their distance from the end of the input, so only the last
+// 64 contribute to the value but every character is still validated.
+UInt256ParseStatus uint256_parse_hex(const char *hex, size_t len, UInt256 *out) {
+  size_t start = 0;
+  if (len >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+    start = 2;
   }
-  for(int i = 0; i < len - remainder; i += 8){
-    char factStr[9] = {0};
-    for (int j = 0; j < 8; j++) {
-    factStr[7 - j] = hex[len - 1 - j - i];
+  if (start == len) {
+    return UINT256_PARSE_EMPTY;
+  }
+
+  UInt256 result = {0};
+  for (size_t i = start; i < len; i++) {
+    uint32_t digit = hexDigitValue[(unsigned char)hex[i]];
+    if (digit > 0xF) {
+      return UINT256_PARSE_INVALID_DIGIT;
+    }
+    size_t pos = len - 1 - i;
+    if (pos < 64) {
+      result.data[pos / 8] |= digit << (4 * (pos % 8));
     }
-    factStr[8] = '\0';  
-    result.data[uIntIndex] = strtoul(factStr , NULL, 16);
-    uIntIndex++;
   }
-  return result;
+  *out = result;
+  return UINT256_PARSE_OK;
 }
 
-
 // Return a dynamically-allocated string of hex digits representing the
 // given UInt256 value.
 char *uint256_format_as_hex(UInt256 val) {
-  char *hex = NULL;
-  int startIndex;
-  for (int i = 7; i >= 0; i--) {
-    if (val.data[i] != 0) {
-      startIndex = i;
-      break;
+  char digits[UINT256_HEX_BUFSIZE];
+  size_t len = uint256_format_hex_into(val, digits, sizeof(digits));
+  char *hex = malloc(len + 1);
+  memcpy(hex, digits, len + 1);
+  return hex;
+}
+
+// Write the hex digits of val (no leading zeros, lowercase) and a
+// terminating NUL into buf, using a nibble lookup table.
+size_t uint256_format_hex_into(UInt256 val, char *buf, size_t cap) {
+  unsigned bits = uint256_bit_length(val);
+  size_t len = bits == 0 ? 1 : (bits + 3) / 4;
+  if (cap < len + 1) {
+    return 0;
+  }
+
+  buf[len] = '\0';
+  for (size_t i = 0; i < len; i++) {
+    buf[len - 1 - i] = hexDigits[(val.data[i / 8] >> (4 * (i % 8))) & 0xF];
+  }
+  return len;
+}
+
+// 10^19, the largest power of ten that fits in a limb. Its top bit is
+// set, so it is already normalized for division by an invariant.
+#define DEC_CHUNK UINT64_C(10000000000000000000)
+#define DEC_CHUNK_DIGITS 19
+
+// floor((2^128 - 1) / DEC_CHUNK) - 2^64, the reciprocal used to divide
+// by DEC_CHUNK (Moller and Granlund, "Improved division by invariant
+// integers", 2011).
+#define DEC_CHUNK_RECIP UINT64_C(0xd83c94fb6d2ac34a)
+
+// Powers of ten from 10^0 to 10^19.
+static const uint64_t decPow10[20] = {
+  UINT64_C(1),
+  UINT64_C(10),
+  UINT64_C(100),
+  UINT64_C(1000),
+  UINT64_C(10000),
+  UINT64_C(100000),
+  UINT64_C(1000000),
+  UINT64_C(10000000),
+  UINT64_C(100000000),
+  UINT64_C(1000000000),
+  UINT64_C(10000000000),
+  UINT64_C(100000000000),
+  UINT64_C(1000000000000),
+  UINT64_C(10000000000000),
+  UINT64_C(100000000000000),
+  UINT64_C(1000000000000000),
+  UINT64_C(10000000000000000),
+  UINT64_C(100000000000000000),
+  UINT64_C(1000000000000000000),
+  UINT64_C(10000000000000000000)
+};
+
+// Two-digit strings "00" through "99", concatenated.
+static const char decPairs[200] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// Divide hi:lo by 10^19 (hi must be less than 10^19), storing the
+// remainder in *rem. A multiply by the reciprocal and at most two
+// corrections replace the hardware divide.
+static uint64_t div_by_dec_chunk(uint64_t hi, uint64_t lo, uint64_t *rem) {
+  uint64_t carry;
+  uint64_t qHi;
+  uint64_t qLo = mul_64x64(DEC_CHUNK_RECIP, hi, &qHi);
+  qLo = addcarry_64(qLo, lo, 0, &carry);
+  qHi = addcarry_64(qHi, hi, carry, &carry) + 1;
+
+  uint64_t r = lo - qHi * DEC_CHUNK;
+  if (r > qLo) {
+    qHi--;
+    r += DEC_CHUNK;
+  }
+  if (r >= DEC_CHUNK) {
+    qHi++;
+    r -= DEC_CHUNK;
+  }
+  *rem = r;
+  return qHi;
+}
+
+// Write the last digits decimal digits of chunk (with leading zeros)
+// into the digits characters that end just before end.
+static void dec_chunk_write(uint64_t chunk, char *end, int digits) {
+  while (digits >= 2) {
+    uint64_t pair = chunk % 100;
+    chunk /= 100;
+    end -= 2;
+    memcpy(end, decPairs + 2 * pair, 2);
+    digits -= 2;
+  }
+  if (digits != 0) {
+    end[-1] = (char)('0' + chunk % 10);
+  }
+}
+
+// Create a UInt256 value from a string of decimal digits.
+UInt256 uint256_create_from_dec(const char *dec) {
+  UInt256 result = {0};
+  uint256_parse_dec(dec, strlen(dec), &result);
+  return result;
+}
+
+// Parse len characters of decimal into *out. Digits are gathered into
+// chunks of up to 19 in a single limb, and each chunk is folded into
+// the result with one multiply-accumulate pass over the limbs.
+UInt256ParseStatus uint256_parse_dec(const char *dec, size_t len, UInt256 *out) {
+  if (len == 0) {
+    return UINT256_PARSE_EMPTY;
+  }
+
+  uint64_t limbs[4] = {0};
+  // The first chunk takes the leftover digits so the rest are full.
+  size_t digits = len % DEC_CHUNK_DIGITS;
+  if (digits == 0) {
+    digits = DEC_CHUNK_DIGITS;
+  }
+  for (size_t i = 0; i < len; i += digits, digits = DEC_CHUNK_DIGITS) {
+    uint64_t chunk = 0;
+    for (size_t j = 0; j < digits; j++) {
+      uint32_t digit = (uint32_t)(unsigned char)dec[i + j] - '0';
+      if (digit > 9) {
+        return UINT256_PARSE_INVALID_DIGIT;
+      }
+      chunk = chunk * 10 + digit;
     }
-    if (i == 0 && val.data[i] == 0) {
-      hex = malloc(2);  // 1 for '0' and 1 for '\0'
-      sprintf(hex, "0");
-      return hex;
+
+    uint64_t carry = chunk;
+    for (int k = 0; k < 4; k++) {
+      limbs[k] = mac_64(0, limbs[k], decPow10[digits], &carry);
+    }
+    if (carry != 0) {
+      return UINT256_PARSE_OVERFLOW;
     }
   }
-  int size = (startIndex + 1) * 8 + 1;
-  hex = malloc(size);
+  *out = uint256_from_limbs(limbs);
+  return UINT256_PARSE_OK;
+}
+
+// Return a dynamically-allocated string of decimal digits representing
+// the given UInt256 value.
+char *uint256_format_as_dec(UInt256 val) {
+  char digits[UINT256_DEC_BUFSIZE];
+  size_t len = uint256_format_dec_into(val, digits, sizeof(digits));
+  char *dec = malloc(len + 1);
+  memcpy(dec, digits, len + 1);
+  return dec;
+}
 
-  char* currentPos = hex;
+// Write the decimal digits of val and a terminating NUL into buf. The
+// value is split into base-10^19 chunks, one limb-by-limb division pass
+// per chunk, and each chunk is written two digits at a time.
+size_t uint256_format_dec_into(UInt256 val, char *buf, size_t cap) {
+  uint64_t limbs[4];
+  uint256_to_limbs(&val, limbs);
 
-  for (int i = startIndex; i >= 0; i--) {
-    if (i == startIndex) {
-      currentPos += sprintf(currentPos, "%x", val.data[i]);  // format without leading 0s for the first non-zero value
-    } else {
-      currentPos += sprintf(currentPos, "%08x", val.data[i]);  // format with leading 0s for the rest
+  // 2^256 < 10^95, so five chunks always suffice
+  uint64_t chunks[5];
+  int numChunks = 0;
+  int n = limbs_count(limbs, 4);
+  do {
+    uint64_t rem = 0;
+    for (int i = n - 1; i >= 0; i--) {
+      limbs[i] = div_by_dec_chunk(rem, limbs[i], &rem);
     }
+    chunks[numChunks++] = rem;
+    n = limbs_count(limbs, n);
+  } while (n > 0);
+
+  int topDigits = 1;
+  while (topDigits < DEC_CHUNK_DIGITS && chunks[numChunks - 1] >= decPow10[topDigits]) {
+    topDigits++;
   }
-  return hex;
+  size_t len = (size_t)(numChunks - 1) * DEC_CHUNK_DIGITS + topDigits;
+  if (cap < len + 1) {
+    return 0;
+  }
+
+  buf[len] = '\0';
+  char *end = buf + len;
+  for (int i = 0; i < numChunks - 1; i++) {
+    dec_chunk_write(chunks[i], end, DEC_CHUNK_DIGITS);
+    end -= DEC_CHUNK_DIGITS;
+  }
+  dec_chunk_write(chunks[numChunks - 1], end, topDigits);
+  return len;
+}
+
+// Read a 32-bit word stored least significant byte first.
+static inline uint32_t load_le32(const uint8_t *p) {
+#ifdef UINT256_LIMBS_ARE_WORDS
+  uint32_t w;
+  memcpy(&w, p, sizeof(w));
+  return w;
+#else
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+#endif
 }
 
+// Read a 32-bit word stored most significant byte first. On
+// little-endian hosts this is a plain load and a bswap (or a single
+// movbe where available).
+static inline uint32_t load_be32(const uint8_t *p) {
+#if defined(UINT256_LIMBS_ARE_WORDS) && defined(__GNUC__)
+  uint32_t w;
+  memcpy(&w, p, sizeof(w));
+  return __builtin_bswap32(w);
+#else
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+#endif
+}
 
-// Get 32 bits of data from a UInt256 value.
-// Index 0 is the least significant 32 bits, index 7 is the most
-// significant 32 bits.
-uint32_t uint256_get_bits(UInt256 val, unsigned index) {
-  uint32_t bits;
-  bits = val.data[index];
-  return bits;
+// Write a 32-bit word least significant byte first.
+static inline void store_le32(uint8_t *p, uint32_t w) {
+#ifdef UINT256_LIMBS_ARE_WORDS
+  memcpy(p, &w, sizeof(w));
+#else
+  p[0] = (uint8_t)w;
+  p[1] = (uint8_t)(w >> 8);
+  p[2] = (uint8_t)(w >> 16);
+  p[3] = (uint8_t)(w >> 24);
+#endif
 }
 
-// Compute the sum of two UInt256 values.
-UInt256 uint256_add(UInt256 left, UInt256 right) {
-  UInt256 result = {0};  // Initialize all elements to zero
-  uint32_t carry = 0;    // Start with no carry
+// Write a 32-bit word most significant byte first.
+static inline void store_be32(uint8_t *p, uint32_t w) {
+#if defined(UINT256_LIMBS_ARE_WORDS) && defined(__GNUC__)
+  w = __builtin_bswap32(w);
+  memcpy(p, &w, sizeof(w));
+#else
+  p[0] = (uint8_t)(w >> 24);
+  p[1] = (uint8_t)(w >> 16);
+  p[2] = (uint8_t)(w >> 8);
+  p[3] = (uint8_t)w;
+#endif
+}
 
+// Load a value from 32 bytes, most significant byte first.
+UInt256 uint256_load_be(const uint8_t *p) {
+  UInt256 result;
   for (int i = 0; i < 8; i++) {
-    uint32_t sumWithoutCarry = left.data[i] + right.data[i];
-    uint32_t sum = sumWithoutCarry + carry;
-    if (sumWithoutCarry < left.data[i] || sum < sumWithoutCarry) {
-      carry = 1;
-    } else {
-      carry = 0;
-    }
-    result.data[i] = sum;  // Store only the lower 32 bits
+    result.data[i] = load_be32(p + 4 * (7 - i));
   }
   return result;
 }
- 
-// Compute the difference of two UInt256 values.
-UInt256 uint256_sub(UInt256 left, UInt256 right) {
-  UInt256 result;
-  right = uint256_negate(right);
 
-  result = uint256_add(left, right);
+// Load a value from 32 bytes, least significant byte first.
+UInt256 uint256_load_le(const uint8_t *p) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = load_le32(p + 4 * i);
+  }
   return result;
 }
 
-// Return the two's-complement negation of the given UInt256 value.
-UInt256 uint256_negate(UInt256 val) {
+// Store a value as 32 bytes, most significant byte first.
+void uint256_store_be(UInt256 val, uint8_t *p) {
   for (int i = 0; i < 8; i++) {
-    val.data[i] = ~val.data[i];
-  }
-  // Add 1
-  uint64_t carry = 1;
-  for (int i = 0; i < 8 && carry; i++) {
-    uint64_t resultWithCarry = (uint64_t)val.data[i] + carry;
-    val.data[i] = (uint32_t)resultWithCarry;  // Take the least significant 32 bits
-    carry = resultWithCarry >> 32;            // Take the carry (if any)
+    store_be32(p + 4 * (7 - i), val.data[i]);
   }
-  return val;
 }
 
-// Return the result of rotating every bit in val nbits to
-// the left.  Any bits shifted past the most significant bit
-// should be shifted back into the least significant bits.
-UInt256 uint256_rotate_left(UInt256 val, unsigned nbits) {
-  if (nbits == 0) {
-    return val;
+// Store a value as 32 bytes, least significant byte first.
+void uint256_store_le(UInt256 val, uint8_t *p) {
+  for (int i = 0; i < 8; i++) {
+    store_le32(p + 4 * i, val.data[i]);
   }
-  UInt256 result = {0};
-  // Account for a 256-bit full cycle
-  nbits = nbits % 256;
-  // Calculate how many block-move (pushing one full array element to the next) we should do
-  unsigned int numRotationsOfOneFullBlock = nbits / 32;
-  // Calculate how many bit move we need to do within an array element (block)
-  unsigned int numRotationsWithinBlock = nbits % 32;
-
-  // Block-move 
-  for (unsigned int i = 0; i < 8; i++) {
-    unsigned int newIndex = (i + numRotationsOfOneFullBlock) % 8;
-    result.data[newIndex] = val.data[i];
-  }
-  // If numRotationsWithinBlock is 0, we don't need further manipulations
-  if (numRotationsWithinBlock == 0) {
-    return result;
+}
+
+// Load n packed 32-byte big-endian records.
+void uint256_load_be_batch(UInt256 *out, const uint8_t *p, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = uint256_load_be(p + 32 * i);
   }
-  // Shift within each 32-bit block and stores the truncated values
-  UInt256 tempShifted = {0}; // Stores the shifted bits, but this is truncated
-  UInt256 tempTruncated = {0}; // Stores the truncated values
-  for (unsigned int i = 0; i < 8; i++) {
-    tempShifted.data[i] = result.data[i] << numRotationsWithinBlock;
-    tempTruncated.data[i] = result.data[i] >> (32 - numRotationsWithinBlock);
+}
+
+// Load n packed 32-byte little-endian records.
+void uint256_load_le_batch(UInt256 *out, const uint8_t *p, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = uint256_load_le(p + 32 * i);
   }
-  // Combine shifted and truncated values
-  for (unsigned int i = 0; i < 8; i++) {
-    int prevIndex = (i + 7) % 8;
-    result.data[i] = tempShifted.data[i] | tempTruncated.data[prevIndex];
+}
+
+// Store n values as packed 32-byte big-endian records.
+void uint256_store_be_batch(uint8_t *p, const UInt256 *vals, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint256_store_be(vals[i], p + 32 * i);
   }
+}
 
-  return result;
+// Store n values as packed 32-byte little-endian records.
+void uint256_store_le_batch(uint8_t *p, const UInt256 *vals, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint256_store_le(vals[i], p + 32 * i);
+  }
 }
 
+// Encode val as a count byte followed by that many bytes of the value,
+// least significant first, with leading zero bytes dropped.
+size_t uint256_encode_varint(UInt256 val, uint8_t *buf, size_t cap) {
+  size_t len = (uint256_bit_length(val) + 7) / 8;
+  if (cap < len + 1) {
+    return 0;
+  }
 
-// Return the result of rotating every bit in val nbits to
-// the right. Any bits shifted past the least significant bit
-// should be shifted back into the most significant bits.
-UInt256 uint256_rotate_right(UInt256 val, unsigned nbits) {
-  if (nbits == 0) {
-    return val;
+  buf[0] = (uint8_t)len;
+  for (size_t i = 0; i < len; i++) {
+    buf[1 + i] = (uint8_t)(val.data[i / 4] >> (8 * (i % 4)));
   }
+  return len + 1;
+}
+
+// Decode one varint whose count byte has already been checked, reading
+// exactly its own bytes.
+static void varint_decode_exact(const uint8_t *buf, size_t len, UInt256 *out) {
   UInt256 result = {0};
-  // Account for a 256-bit full cycle
-  nbits = nbits % 256;
-  // Calculate how many block-move (pushing one full array element to the next) we should do
-  unsigned int numRotationsOfOneFullBlock = nbits / 32;
-  // Calculate how many bit move we need to do within an array element (block)
-  unsigned int numRotationsWithinBlock = nbits % 32;
-  
-  // Block-move
-  for (int i = 7; i >= 0; i--) {
-    int newIndex = (i - numRotationsOfOneFullBlock + 8) % 8;
-    result.data[newIndex] = val.data[i];
+  for (size_t i = 0; i < len; i++) {
+    result.data[i / 4] |= (uint32_t)buf[1 + i] << (8 * (i % 4));
   }
-  // If numRotationsWithinBlock is 0, no further manipulation is needed.
-  if (numRotationsWithinBlock == 0) {
-    return result;
+  *out = result;
+}
+
+// Decode one varint when at least UINT256_VARINT_MAX bytes are readable.
+// All 32 value bytes are loaded unconditionally and the ones past the
+// count are masked off, so there is no loop that depends on the count.
+static void varint_decode_wide(const uint8_t *buf, size_t len, UInt256 *out) {
+  for (int i = 0; i < 8; i++) {
+    size_t avail = len > (size_t)4 * i ? len - (size_t)4 * i : 0;
+    size_t bytes = avail < 4 ? avail : 4;
+    uint32_t mask = (uint32_t)((UINT64_C(1) << (8 * bytes)) - 1);
+    out->data[i] = load_le32(buf + 1 + 4 * i) & mask;
   }
-  // Shift within each 32-bit block and stores the truncated values
-  UInt256 tempShifted = {0}; // Stores the shifted bits, but this is truncated
-  UInt256 tempTruncated = {0}; // Stores the truncated values
-  for (int i = 7; i >= 0; i--) {
-    tempShifted.data[i] = result.data[i] >> numRotationsWithinBlock;
-    tempTruncated.data[i] = result.data[i] << (32 - numRotationsWithinBlock); 
+}
+
+// Check a count byte against the available input. Returns the number of
+// value bytes, or -1 if the varint is malformed or truncated.
+static int varint_check(const uint8_t *buf, size_t avail) {
+  if (avail == 0) {
+    return -1;
   }
-  // Combine shifted and truncated values
-  for (int i = 7; i >= 0; i--) {
-    int prevIndex = (i + 1) % 8;
-    result.data[i] = tempShifted.data[i] | tempTruncated.data[prevIndex];
+  size_t len = buf[0];
+  if (len > 32 || avail < len + 1 || (len > 0 && buf[len] == 0)) {
+    return -1;
   }
-  
-  return result;
-}
\ No newline at end of file
+  return (int)len;
+}
+
+// Decode one varint from the avail bytes at buf.
+size_t uint256_decode_varint(const uint8_t *buf, size_t avail, UInt256 *out) {
+  int len = varint_check(buf, avail);
+  if (len < 0) {
+    return 0;
+  }
+  if (avail >= UINT256_VARINT_MAX) {
+    varint_decode_wide(buf, (size_t)len, out);
+  } else {
+    varint_decode_exact(buf, (size_t)len, out);
+  }
+  return (size_t)len + 1;
+}
+
+// Decode n consecutive varints from the avail bytes at buf.
+size_t uint256_decode_varint_batch(UInt256 *out, size_t n, const uint8_t *buf, size_t avail) {
+  size_t pos = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t used = uint256_decode_varint(buf + pos, avail - pos, &out[i]);
+    if (used == 0) {
+      return 0;
+    }
+    pos += used;
+  }
+  return pos;
+}
+
+// Get 32 bits of data from a UInt256 value.
+// Index 0 is the least significant 32 bits, index 7 is the most
+// significant 32 bits.
+uint32_t uint256_get_bits(UInt256 val, unsigned index) {
+  uint32_t bits;
+  bits = val.data[index];
+  return bits;
+}
+
+// Compute the sum of two UInt256 values.
+UInt256 uint256_add(UInt256 left, UInt256 right) {
+  UInt256 result;
+  uint256_add_to(&result, &left, &right);
+  return result;
+}
+ 
+// Compute the difference of two UInt256 values.
+UInt256 uint256_sub(UInt256 left, UInt256 right) {
+  UInt256 result;
+  uint256_sub_to(&result, &left, &right);
+  return result;
+}
+
+// Return the two's-complement negation of the given UInt256 value.
+UInt256 uint256_negate(UInt256 val) {
+  uint256_negate_to(&val, &val);
+  return val;
+}
+
+// Store the sum of *left and *right in *dst. dst may alias either
+// operand. Addition is branch-free, so this shares the constant-time
+// implementation.
+void uint256_add_to(UInt256 *dst, const UInt256 *left, const UInt256 *right) {
+  *dst = uint256_ct_add(*left, *right);
+}
+
+// Store the difference of *left and *right in *dst. dst may alias
+// either operand. Like addition, this shares the constant-time
+// implementation.
+void uint256_sub_to(UInt256 *dst, const UInt256 *left, const UInt256 *right) {
+  *dst = uint256_ct_sub(*left, *right);
+}
+
+// Store the two's-complement negation of *val in *dst. dst may alias val.
+void uint256_negate_to(UInt256 *dst, const UInt256 *val) {
+  *dst = uint256_ct_negate(*val);
+}
+
+// Compute left + right + carryIn (carryIn must be 0 or 1). The carry
+// out of the most significant bit is stored in *carryOut unless it
+// is NULL.
+UInt256 uint256_add_carry(UInt256 left, UInt256 right, unsigned carryIn, unsigned *carryOut) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  uint64_t carry = limbs_adc(a, a, b, carryIn);
+  if (carryOut != NULL) {
+    *carryOut = (unsigned)carry;
+  }
+  return uint256_from_limbs(a);
+}
+
+// Compute left - right - borrowIn (borrowIn must be 0 or 1). The
+// borrow out of the most significant bit is stored in *borrowOut
+// unless it is NULL.
+UInt256 uint256_sub_borrow(UInt256 left, UInt256 right, unsigned borrowIn, unsigned *borrowOut) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  uint64_t borrow = limbs_sbb(a, a, b, borrowIn);
+  if (borrowOut != NULL) {
+    *borrowOut = (unsigned)borrow;
+  }
+  return uint256_from_limbs(a);
+}
+
+// Compute the sum of two UInt512 values (modulo 2^512).
+UInt512 uint512_add(UInt512 left, UInt512 right) {
+  UInt512 result;
+  unsigned carry;
+  result.lo = uint256_add_carry(left.lo, right.lo, 0, &carry);
+  result.hi = uint256_add_carry(left.hi, right.hi, carry, NULL);
+  return result;
+}
+
+// Compute the difference of two UInt512 values (modulo 2^512).
+UInt512 uint512_sub(UInt512 left, UInt512 right) {
+  UInt512 result;
+  unsigned borrow;
+  result.lo = uint256_sub_borrow(left.lo, right.lo, 0, &borrow);
+  result.hi = uint256_sub_borrow(left.hi, right.hi, borrow, NULL);
+  return result;
+}
+
+// Compare two UInt256 values.
+int uint256_cmp(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  return limbs_cmp(a, b);
+}
+
+// Return 1 if left equals right, folding the differences together
+// instead of stopping at the first one.
+int uint256_eq(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  uint64_t diff = (a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3]);
+  return diff == 0;
+}
+
+// Return 1 if left is less than right: the borrow out of left - right.
+int uint256_lt(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], diff[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  return (int)limbs_sub(diff, a, b);
+}
+
+// Compare two UInt256 values in constant time, using the borrows out of
+// both subtractions.
+int uint256_ct_cmp(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], diff[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  uint64_t less = limbs_sub(diff, a, b);
+  uint64_t greater = limbs_sub(diff, b, a);
+  return (int)greater - (int)less;
+}
+
+// The uint256_ct_* operations below run the same instructions and
+// touch the same memory whatever the values (and rotate counts) are.
+
+// Compute left + right in constant time.
+UInt256 uint256_ct_add(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  limbs_add(a, a, b);
+  return uint256_from_limbs(a);
+}
+
+// Compute left - right in constant time. The borrow is propagated
+// directly rather than negating right and adding.
+UInt256 uint256_ct_sub(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  limbs_sub(a, a, b);
+  return uint256_from_limbs(a);
+}
+
+// Compute -val in constant time.
+UInt256 uint256_ct_negate(UInt256 val) {
+  uint64_t zero[4] = {0}, a[4];
+  uint256_to_limbs(&val, a);
+  limbs_sub(a, zero, a);
+  return uint256_from_limbs(a);
+}
+
+// Return a if cond is nonzero and b otherwise, by masking rather than
+// branching.
+UInt256 uint256_ct_select(unsigned cond, UInt256 a, UInt256 b) {
+  uint32_t mask = (uint32_t)ct_barrier(mask_if(cond));
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = b.data[i] ^ (mask & (a.data[i] ^ b.data[i]));
+  }
+  return result;
+}
+
+// Swap *a and *b if cond is nonzero. Both are always read and written.
+void uint256_ct_cswap(unsigned cond, UInt256 *a, UInt256 *b) {
+  uint32_t mask = (uint32_t)ct_barrier(mask_if(cond));
+  for (int i = 0; i < 8; i++) {
+    uint32_t diff = mask & (a->data[i] ^ b->data[i]);
+    a->data[i] ^= diff;
+    b->data[i] ^= diff;
+  }
+}
+
+// Rotate left in constant time: every limb is mask-selected and every
+// funnel shift is done, whatever the count.
+UInt256 uint256_ct_rotate_left(UInt256 val, unsigned nbits) {
+  uint64_t a[4], result[4];
+  uint256_to_limbs(&val, a);
+  limbs_rotate_left(a, nbits % 256, result);
+  return uint256_from_limbs(result);
+}
+
+// Rotate right in constant time, as a left rotation by the complement.
+UInt256 uint256_ct_rotate_right(UInt256 val, unsigned nbits) {
+  uint64_t a[4], result[4];
+  uint256_to_limbs(&val, a);
+  limbs_rotate_left(a, (256 - nbits % 256) % 256, result);
+  return uint256_from_limbs(result);
+}
+
+// Store the low 256 bits of the product of *left and *right in *dst.
+// dst may alias either operand.
+void uint256_mul_to(UInt256 *dst, const UInt256 *left, const UInt256 *right) {
+  uint64_t a[4], b[4], product[4];
+  uint256_to_limbs(left, a);
+  uint256_to_limbs(right, b);
+  limbs_mul(a, b, product, 4);
+  *dst = uint256_from_limbs(product);
+}
+
+// Compute the product of two UInt256 values. Only the least-significant
+// 256 bits of the product are returned.
+UInt256 uint256_mul(UInt256 left, UInt256 right) {
+  UInt256 result;
+  uint256_mul_to(&result, &left, &right);
+  return result;
+}
+
+// Compute the full 512-bit product of two UInt256 values.
+UInt512 uint256_mul_wide(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], product[8];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  limbs_mul(a, b, product, 8);
+
+  UInt512 result;
+  result.lo = uint256_from_limbs(product);
+  result.hi = uint256_from_limbs(product + 4);
+  return result;
+}
+
+// Divide num by den, storing the quotient in *quot and the remainder
+// in *rem. Either pointer may be NULL if that result isn't needed.
+// Division by zero stores zero in both results.
+void uint256_divmod(UInt256 num, UInt256 den, UInt256 *quot, UInt256 *rem) {
+  UInt256 quotient = {0};
+  UInt256 remainder = {0};
+  uint64_t u[4], v[4];
+  uint256_to_limbs(&num, u);
+  uint256_to_limbs(&den, v);
+  int m = limbs_count(u, 4);
+  int n = limbs_count(v, 4);
+
+  if (n == 0) {
+    // Division by zero: leave both results zero
+  } else if (limbs_bit_length(u) < limbs_bit_length(v)) {
+    remainder = num;
+  } else if (uint256_popcount(den) == 1) {
+    // A power of two: shift for the quotient, mask for the remainder
+    unsigned shift = uint256_ctz(den);
+    uint64_t q[4], r[4], one[4] = {1, 0, 0, 0};
+    limbs_shr(u, shift, q);
+    limbs_sub(v, v, one);
+    for (int i = 0; i < 4; i++) {
+      r[i] = u[i] & v[i];
+    }
+    quotient = uint256_from_limbs(q);
+    remainder = uint256_from_limbs(r);
+  } else if (n == 1 && v[0] <= 0xFFFFFFFFU) {
+    // Short division by a 32-bit divisor needs only 64-bit arithmetic
+    uint64_t divisor = v[0];
+    uint64_t partial = 0;
+    for (int i = 7; i >= 0; i--) {
+      uint64_t current = (partial << 32) | num.data[i];
+      quotient.data[i] = (uint32_t)(current / divisor);
+      partial = current % divisor;
+    }
+    remainder.data[0] = (uint32_t)partial;
+  } else {
+    uint64_t q[4] = {0}, r[4] = {0};
+    limbs_divmod(u, m, v, n, q, r);
+    quotient = uint256_from_limbs(q);
+    remainder = uint256_from_limbs(r);
+  }
+
+  if (quot != NULL) {
+    *quot = quotient;
+  }
+  if (rem != NULL) {
+    *rem = remainder;
+  }
+}
+
+// Compute the quotient of two UInt256 values (zero if right is zero).
+UInt256 uint256_div(UInt256 left, UInt256 right) {
+  UInt256 result;
+  uint256_divmod(left, right, &result, NULL);
+  return result;
+}
+
+// Compute the remainder of two UInt256 values (zero if right is zero).
+UInt256 uint256_mod(UInt256 left, UInt256 right) {
+  UInt256 result;
+  uint256_divmod(left, right, NULL, &result);
+  return result;
+}
+
+// Return the result of rotating every bit in val nbits to
+// the left.  Any bits shifted past the most significant bit
+// should be shifted back into the least significant bits.
+UInt256 uint256_rotate_left(UInt256 val, unsigned nbits) {
+  UInt256 result;
+  uint256_rotate_left_to(&result, &val, nbits);
+  return result;
+}
+
+
+// Return the result of rotating every bit in val nbits to
+// the right. Any bits shifted past the least significant bit
+// should be shifted back into the most significant bits.
+UInt256 uint256_rotate_right(UInt256 val, unsigned nbits) {
+  UInt256 result;
+  uint256_rotate_right_to(&result, &val, nbits);
+  return result;
+}
+
+// Store the result of rotating *val left by nbits in *dst. dst may
+// alias val. Rotation is branch-free whatever the count, so this
+// shares the constant-time implementation.
+void uint256_rotate_left_to(UInt256 *dst, const UInt256 *val, unsigned nbits) {
+  *dst = uint256_ct_rotate_left(*val, nbits);
+}
+
+// Store the result of rotating *val right by nbits in *dst. dst may
+// alias val.
+void uint256_rotate_right_to(UInt256 *dst, const UInt256 *val, unsigned nbits) {
+  *dst = uint256_ct_rotate_right(*val, nbits);
+}
+
+// Return val shifted left by nbits. Bits shifted past the most
+// significant bit are discarded; shifting by 256 or more gives 0.
+UInt256 uint256_shl(UInt256 val, unsigned nbits) {
+  uint64_t a[4], result[4];
+  uint256_to_limbs(&val, a);
+  limbs_shl(a, nbits, result);
+  return uint256_from_limbs(result);
+}
+
+// Return val shifted right by nbits (a logical shift). Shifting by
+// 256 or more gives 0.
+UInt256 uint256_shr(UInt256 val, unsigned nbits) {
+  uint64_t a[4], result[4];
+  uint256_to_limbs(&val, a);
+  limbs_shr(a, nbits, result);
+  return uint256_from_limbs(result);
+}
+
+// Return the bitwise AND of left and right.
+UInt256 uint256_and(UInt256 left, UInt256 right) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = left.data[i] & right.data[i];
+  }
+  return result;
+}
+
+// Return the bitwise OR of left and right.
+UInt256 uint256_or(UInt256 left, UInt256 right) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = left.data[i] | right.data[i];
+  }
+  return result;
+}
+
+// Return the bitwise XOR of left and right.
+UInt256 uint256_xor(UInt256 left, UInt256 right) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = left.data[i] ^ right.data[i];
+  }
+  return result;
+}
+
+// Return left with the bits set in right cleared (left & ~right).
+UInt256 uint256_andnot(UInt256 left, UInt256 right) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = left.data[i] & ~right.data[i];
+  }
+  return result;
+}
+
+// Return val with every bit flipped.
+UInt256 uint256_not(UInt256 val) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = ~val.data[i];
+  }
+  return result;
+}
+
+// Count leading zero bits, scanning limbs from the top.
+unsigned uint256_clz(UInt256 val) {
+  uint64_t a[4];
+  uint256_to_limbs(&val, a);
+  return 256 - (unsigned)limbs_bit_length(a);
+}
+
+// Count trailing zero bits, scanning limbs from the bottom.
+unsigned uint256_ctz(UInt256 val) {
+  uint64_t a[4];
+  uint256_to_limbs(&val, a);
+  for (int i = 0; i < 4; i++) {
+    if (a[i] != 0) {
+      return 64 * (unsigned)i + (unsigned)ctz_64(a[i]);
+    }
+  }
+  return 256;
+}
+
+// Count the set bits.
+unsigned uint256_popcount(UInt256 val) {
+  uint64_t a[4];
+  uint256_to_limbs(&val, a);
+  return (unsigned)(popcount_64(a[0]) + popcount_64(a[1]) + popcount_64(a[2]) + popcount_64(a[3]));
+}
+
+// Return the number of bits needed to represent val.
+unsigned uint256_bit_length(UInt256 val) {
+  uint64_t a[4];
+  uint256_to_limbs(&val, a);
+  return (unsigned)limbs_bit_length(a);
+}
+
+// Return bit index of val.
+int uint256_test_bit(UInt256 val, unsigned index) {
+  return index < 256 ? (int)((val.data[index / 32] >> (index % 32)) & 1) : 0;
+}
+
+// Return width bits of val starting at bit lo. Widths above 64 are
+// clamped to 64.
+uint64_t uint256_extract_bits(UInt256 val, unsigned lo, unsigned width) {
+  uint64_t a[4];
+  uint256_to_limbs(&val, a);
+  return limbs_extract(a, lo, width);
+}
+
+// Initialize a Montgomery context for the given modulus. Returns 1 on
+// success, or 0 if the modulus is even (Montgomery reduction needs an
+// odd modulus).
+int uint256_mont_init(UInt256MontCtx *ctx, UInt256 mod) {
+  if ((mod.data[0] & 1) == 0) {
+    return 0;
+  }
+  uint64_t n[4];
+  uint256_to_limbs(&mod, n);
+
+  // Newton iteration for n^-1 mod 2^64: each step doubles the number of
+  // correct low bits, starting from 3 (n * n == 1 mod 8 for odd n)
+  uint64_t inv = n[0];
+  for (int i = 0; i < 5; i++) {
+    inv *= 2 - n[0] * inv;
+  }
+  ctx->mod = mod;
+  ctx->n0inv = 0 - inv;
+
+  // R^2 mod n, where R = 2^256, computed as (R mod n)^2 mod n
+  uint64_t r[4], wide[8];
+  uint64_t rWide[8] = {0, 0, 0, 0, 1, 0, 0, 0};
+  limbs_mod_wide(rWide, n, r);
+  limbs_sqr(r, wide);
+  limbs_mod_wide(wide, n, r);
+  ctx->r2 = uint256_from_limbs(r);
+  return 1;
+}
+
+// Convert a value into Montgomery form (val * 2^256 mod modulus).
+UInt256 uint256_to_mont(const UInt256MontCtx *ctx, UInt256 val) {
+  return uint256_mont_mul(ctx, val, ctx->r2);
+}
+
+// Convert a value out of Montgomery form (val * 2^-256 mod modulus).
+UInt256 uint256_from_mont(const UInt256MontCtx *ctx, UInt256 val) {
+  uint64_t n[4], t[8] = {0}, result[4];
+  uint256_to_limbs(&ctx->mod, n);
+  uint256_to_limbs(&val, t);
+  mont_reduce(n, ctx->n0inv, t, result);
+  return uint256_from_limbs(result);
+}
+
+// Multiply two values in Montgomery form. Both operands must be less
+// than the modulus; the result is in Montgomery form.
+UInt256 uint256_mont_mul(const UInt256MontCtx *ctx, UInt256 left, UInt256 right) {
+  uint64_t n[4], a[4], b[4], result[4];
+  uint256_to_limbs(&ctx->mod, n);
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  mont_mul_limbs(n, ctx->n0inv, a, b, result);
+  return uint256_from_limbs(result);
+}
+
+// Square a value in Montgomery form. The operand must be less than the
+// modulus; the result is in Montgomery form.
+UInt256 uint256_mont_sqr(const UInt256MontCtx *ctx, UInt256 val) {
+  uint64_t n[4], a[4], result[4];
+  uint256_to_limbs(&ctx->mod, n);
+  uint256_to_limbs(&val, a);
+  mont_sqr_limbs(n, ctx->n0inv, a, result);
+  return uint256_from_limbs(result);
+}
+
+// Compute (left * right) mod mod using the full 512-bit product.
+// Returns zero if mod is zero.
+UInt256 uint256_mulmod(UInt256 left, UInt256 right, UInt256 mod) {
+  uint64_t a[4], b[4], n[4], t[8], result[4] = {0};
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  uint256_to_limbs(&mod, n);
+  if (limbs_count(n, 4) != 0) {
+    limbs_mul(a, b, t, 8);
+    limbs_mod_wide(t, n, result);
+  }
+  return uint256_from_limbs(result);
+}
+
+// Modular arithmetic state used by exponentiation. Odd moduli work in
+// Montgomery form; even moduli fall back to reducing full products by
+// division.
+typedef struct {
+  uint64_t mod[4];
+  uint64_t r2[4];
+  uint64_t n0inv;
+  int montgomery;
+} ModArith;
+
+// Set up modular arithmetic for a nonzero modulus.
+static void modarith_init(ModArith *arith, UInt256 mod) {
+  UInt256MontCtx ctx;
+  uint256_to_limbs(&mod, arith->mod);
+  arith->montgomery = uint256_mont_init(&ctx, mod);
+  if (arith->montgomery) {
+    uint256_to_limbs(&ctx.r2, arith->r2);
+    arith->n0inv = ctx.n0inv;
+  }
+}
+
+// Multiply two values in the working representation.
+static void modarith_mul(const ModArith *arith, const uint64_t a[4], const uint64_t b[4], uint64_t out[4]) {
+  if (arith->montgomery) {
+    mont_mul_limbs(arith->mod, arith->n0inv, a, b, out);
+  } else {
+    uint64_t t[8];
+    limbs_mul(a, b, t, 8);
+    limbs_mod_wide(t, arith->mod, out);
+  }
+}
+
+// Square a value in the working representation.
+static void modarith_sqr(const ModArith *arith, const uint64_t a[4], uint64_t out[4]) {
+  if (arith->montgomery) {
+    mont_sqr_limbs(arith->mod, arith->n0inv, a, out);
+  } else {
+    uint64_t t[8];
+    limbs_sqr(a, t);
+    limbs_mod_wide(t, arith->mod, out);
+  }
+}
+
+// Convert an arbitrary value into the (reduced) working representation.
+static void modarith_enter(const ModArith *arith, const uint64_t a[4], uint64_t out[4]) {
+  if (arith->montgomery) {
+    mont_mul_limbs(arith->mod, arith->n0inv, a, arith->r2, out);
+  } else {
+    uint64_t t[8] = {a[0], a[1], a[2], a[3], 0, 0, 0, 0};
+    limbs_mod_wide(t, arith->mod, out);
+  }
+}
+
+// Convert a value out of the working representation.
+static void modarith_leave(const ModArith *arith, const uint64_t a[4], uint64_t out[4]) {
+  uint64_t t[8] = {a[0], a[1], a[2], a[3], 0, 0, 0, 0};
+  if (arith->montgomery) {
+    mont_reduce(arith->mod, arith->n0inv, t, out);
+  } else {
+    for (int i = 0; i < 4; i++) {
+      out[i] = a[i];
+    }
+  }
+}
+
+// Width of the sliding window used by uint256_modexp. A width of 5
+// needs 16 precomputed odd powers and averages about one multiply per
+// six exponent bits.
+#define MODEXP_WINDOW 5
+
+// Compute (base ^ exp) mod mod using a left-to-right sliding-window
+// scan of the exponent. Returns zero if mod is zero.
+UInt256 uint256_modexp(UInt256 base, UInt256 exp, UInt256 mod) {
+  uint64_t n[4], e[4], b[4], result[4] = {0};
+  uint256_to_limbs(&mod, n);
+  uint256_to_limbs(&exp, e);
+  uint256_to_limbs(&base, b);
+  if (limbs_count(n, 4) == 0 || (limbs_count(n, 4) == 1 && n[0] == 1)) {
+    return uint256_from_limbs(result);
+  }
+
+  ModArith arith;
+  modarith_init(&arith, mod);
+  int nbits = limbs_bit_length(e);
+  if (nbits == 0) {
+    // base^0 = 1
+    result[0] = 1;
+    return uint256_from_limbs(result);
+  }
+
+  // table[k] holds base^(2k + 1)
+  uint64_t table[1 << (MODEXP_WINDOW - 1)][4];
+  uint64_t baseSquared[4];
+  modarith_enter(&arith, b, table[0]);
+  modarith_sqr(&arith, table[0], baseSquared);
+  for (int k = 1; k < (1 << (MODEXP_WINDOW - 1)); k++) {
+    modarith_mul(&arith, table[k - 1], baseSquared, table[k]);
+  }
+
+  uint64_t acc[4];
+  int started = 0;
+  int i = nbits - 1;
+  while (i >= 0) {
+    if (!limbs_bit(e, i)) {
+      modarith_sqr(&arith, acc, acc);
+      i--;
+      continue;
+    }
+    // Take the longest window of at most MODEXP_WINDOW bits that
+    // starts at bit i and ends on a 1 bit
+    int low = i - MODEXP_WINDOW + 1 < 0 ? 0 : i - MODEXP_WINDOW + 1;
+    unsigned window = (unsigned)limbs_extract(e, (unsigned)low, (unsigned)(i - low + 1));
+    int skip = ctz_64(window);
+    low += skip;
+    window >>= skip;
+    if (started) {
+      for (int j = i; j >= low; j--) {
+        modarith_sqr(&arith, acc, acc);
+      }
+      modarith_mul(&arith, acc, table[window >> 1], acc);
+    } else {
+      // The first window needs no squarings: start from its table entry
+      for (int j = 0; j < 4; j++) {
+        acc[j] = table[window >> 1][j];
+      }
+      started = 1;
+    }
+    i = low - 1;
+  }
+
+  modarith_leave(&arith, acc, result);
+  return uint256_from_limbs(result);
+}
+
+// Precompute the table for a fixed base and odd modulus. Returns 1 on
+// success, or 0 if the modulus is even.
+int uint256_fixed_base_init(UInt256FixedBase *fb, UInt256 base, UInt256 mod) {
+  if (!uint256_mont_init(&fb->ctx, mod)) {
+    return 0;
+  }
+  // table[i][d - 1] = base^(d * 16^i): each row starts from the
+  // previous row's 16th power
+  UInt256 power = uint256_to_mont(&fb->ctx, base);
+  for (int i = 0; i < 64; i++) {
+    fb->table[i][0] = power;
+    for (int d = 1; d < 15; d++) {
+      fb->table[i][d] = uint256_mont_mul(&fb->ctx, fb->table[i][d - 1], power);
+    }
+    power = uint256_mont_mul(&fb->ctx, fb->table[i][14], power);
+  }
+  return 1;
+}
+
+// Compute (base ^ exp) mod mod for the base and modulus that fb was
+// initialized with. Each 4-bit digit of the exponent selects one table
+// entry, so at most 64 multiplications and no squarings are needed.
+UInt256 uint256_fixed_base_exp(const UInt256FixedBase *fb, UInt256 exp) {
+  uint64_t n[4], e[4], acc[4], result[4];
+  uint256_to_limbs(&fb->ctx.mod, n);
+  uint256_to_limbs(&exp, e);
+  int ndigits = (limbs_bit_length(e) + 3) / 4;
+
+  // Start from 1 in Montgomery form (2^256 mod n)
+  uint64_t oneWide[8] = {0, 0, 0, 0, 1, 0, 0, 0};
+  limbs_mod_wide(oneWide, n, acc);
+  for (int i = 0; i < ndigits; i++) {
+    unsigned digit = (unsigned)limbs_extract(e, 4 * (unsigned)i, 4);
+    if (digit != 0) {
+      uint64_t entry[4];
+      uint256_to_limbs(&fb->table[i][digit - 1], entry);
+      mont_mul_limbs(n, fb->ctx.n0inv, acc, entry, acc);
+    }
+  }
+
+  uint64_t t[8] = {acc[0], acc[1], acc[2], acc[3], 0, 0, 0, 0};
+  mont_reduce(n, fb->ctx.n0inv, t, result);
+  return uint256_from_limbs(result);
+}
+
+// Special-form field arithmetic. Both primes are close to a power of
+// two, so a 512-bit product can be reduced with a few multiply-adds or
+// word additions instead of Montgomery reduction or division.
+typedef void (*FpReduceFn)(const uint64_t t[8], uint64_t out[4]);
+
+// The secp256k1 prime p = 2^256 - 2^32 - 977
+static const uint64_t FP_K1_P[4] = {
+  0xFFFFFFFEFFFFFC2FU, 0xFFFFFFFFFFFFFFFFU, 0xFFFFFFFFFFFFFFFFU, 0xFFFFFFFFFFFFFFFFU
+};
+
+// 2^256 mod p for secp256k1 (2^32 + 977)
+#define FP_K1_C 0x1000003D1U
+
+// The NIST P-256 prime p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+static const uint64_t FP_P256_P[4] = {
+  0xFFFFFFFFFFFFFFFFU, 0x00000000FFFFFFFFU, 0x0000000000000000U, 0xFFFFFFFF00000001U
+};
+
+// Return (a + b) mod p for a, b < p.
+static void fp_add(const uint64_t p[4], const uint64_t a[4], const uint64_t b[4], uint64_t out[4]) {
+  uint64_t sum[4], diff[4];
+  uint64_t carry = limbs_add(sum, a, b);
+  uint64_t borrow = limbs_sub(diff, sum, p);
+  uint64_t keepDiff = 0 - (carry | (borrow ^ 1));
+  for (int i = 0; i < 4; i++) {
+    out[i] = (diff[i] & keepDiff) | (sum[i] & ~keepDiff);
+  }
+}
+
+// Return (a - b) mod p for a, b < p.
+static void fp_sub(const uint64_t p[4], const uint64_t a[4], const uint64_t b[4], uint64_t out[4]) {
+  uint64_t diff[4], fixed[4];
+  uint64_t borrow = limbs_sub(diff, a, b);
+  limbs_add(fixed, diff, p);
+  uint64_t keepFixed = 0 - borrow;
+  for (int i = 0; i < 4; i++) {
+    out[i] = (fixed[i] & keepFixed) | (diff[i] & ~keepFixed);
+  }
+}
+
+// Reduce a product t < p^2 modulo the secp256k1 prime. Since
+// 2^256 = C (mod p), the high half is folded into the low half as
+// hi * C, twice, followed by one conditional subtraction.
+static void fp_k1_reduce(const uint64_t t[8], uint64_t out[4]) {
+  uint64_t r[4], carry = 0;
+  for (int i = 0; i < 4; i++) {
+    r[i] = mac_64(t[i], t[i + 4], FP_K1_C, &carry);
+  }
+
+  // Fold the carry limb (less than 2^34) the same way
+  uint64_t foldHi;
+  uint64_t foldLo = mul_64x64(carry, FP_K1_C, &foldHi);
+  uint64_t fold[4] = {foldLo, foldHi, 0, 0};
+  uint64_t overflow = limbs_add(r, r, fold);
+
+  // If that wrapped past 2^256, r is now tiny and adding C can't carry
+  uint64_t wrap[4] = {FP_K1_C & (0 - overflow), 0, 0, 0};
+  limbs_add(r, r, wrap);
+
+  uint64_t diff[4];
+  uint64_t borrow = limbs_sub(diff, r, FP_K1_P);
+  uint64_t keepDiff = borrow - 1;
+  for (int i = 0; i < 4; i++) {
+    out[i] = (diff[i] & keepDiff) | (r[i] & ~keepDiff);
+  }
+}
+
+// Propagate signed carries through eight 32-bit word accumulators,
+// storing the words in w and returning the signed carry out of the top.
+static int64_t fp_p256_propagate(const int64_t acc[8], uint32_t w[8]) {
+  int64_t carry = 0;
+  for (int i = 0; i < 8; i++) {
+    int64_t sum = acc[i] + carry;
+    w[i] = (uint32_t)sum;
+    carry = (sum - (int64_t)w[i]) / 4294967296;  // exact floor division
+  }
+  return carry;
+}
+
+// Reduce a product t < p^2 modulo the P-256 prime using the NIST fast
+// reduction (FIPS 186-4, D.2.3), which rewrites the high 32-bit words
+// as a signed sum of nine 256-bit terms.
+static void fp_p256_reduce(const uint64_t t[8], uint64_t out[4]) {
+  int64_t c[16];
+  for (int i = 0; i < 8; i++) {
+    c[2 * i] = (int64_t)(t[i] & 0xFFFFFFFFU);
+    c[2 * i + 1] = (int64_t)(t[i] >> 32);
+  }
+
+  // s1 + 2*s2 + 2*s3 + s4 + s5 - s6 - s7 - s8 - s9, word by word
+  int64_t acc[8];
+  acc[0] = c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+  acc[1] = c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+  acc[2] = c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+  acc[3] = c[3] + 2 * c[11] + 2 * c[12] + c[13] - c[15] - c[8] - c[9];
+  acc[4] = c[4] + 2 * c[12] + 2 * c[13] + c[14] - c[9] - c[10];
+  acc[5] = c[5] + 2 * c[13] + 2 * c[14] + c[15] - c[10] - c[11];
+  acc[6] = c[6] + 3 * c[14] + 2 * c[15] + c[13] - c[8] - c[9];
+  acc[7] = c[7] + 3 * c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+  uint32_t w[8];
+  int64_t top = fp_p256_propagate(acc, w);
+
+  // Fold the small signed top carry back in using
+  // 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod p)
+  for (int i = 0; i < 8; i++) {
+    acc[i] = w[i];
+  }
+  acc[0] += top;
+  acc[3] -= top;
+  acc[6] -= top;
+  acc[7] += top;
+  top = fp_p256_propagate(acc, w);
+
+  // The value top * 2^256 + w now lies in (-p, 2p) with top in
+  // {-1, 0, 1}: add p, subtract p, or conditionally subtract p
+  uint64_t r[4], minusP[4], plusP[4];
+  for (int i = 0; i < 4; i++) {
+    r[i] = (uint64_t)w[2 * i] | ((uint64_t)w[2 * i + 1] << 32);
+  }
+  uint64_t borrow = limbs_sub(minusP, r, FP_P256_P);
+  limbs_add(plusP, r, FP_P256_P);
+  uint64_t usePlus = 0 - (uint64_t)(top < 0);
+  uint64_t useMinus = 0 - (uint64_t)(top > 0 || (top == 0 && !borrow));
+  for (int i = 0; i < 4; i++) {
+    out[i] = (plusP[i] & usePlus) | (minusP[i] & useMinus) | (r[i] & ~(usePlus | useMinus));
+  }
+}
+
+// Apply a special-form reduction to the product of two reduced values.
+static UInt256 fp_mul(FpReduceFn reduce, UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], t[8], result[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  limbs_mul(a, b, t, 8);
+  reduce(t, result);
+  return uint256_from_limbs(result);
+}
+
+// Apply a special-form reduction to the square of a reduced value.
+static UInt256 fp_sqr(FpReduceFn reduce, UInt256 val) {
+  uint64_t a[4], t[8], result[4];
+  uint256_to_limbs(&val, a);
+  limbs_sqr(a, t);
+  reduce(t, result);
+  return uint256_from_limbs(result);
+}
+
+// Invert a reduced value with constant-time safegcd, which is about
+// ten times faster than raising it to p - 2. Zero maps to zero.
+static UInt256 fp_inv(const uint64_t p[4], UInt256 val) {
+  return uint256_ct_modinv(val, uint256_from_limbs(p));
+}
+
+// Compute (left + right) mod p for the secp256k1 prime.
+UInt256 uint256_fp_k1_add(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], result[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  fp_add(FP_K1_P, a, b, result);
+  return uint256_from_limbs(result);
+}
+
+// Compute (left - right) mod p for the secp256k1 prime.
+UInt256 uint256_fp_k1_sub(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], result[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  fp_sub(FP_K1_P, a, b, result);
+  return uint256_from_limbs(result);
+}
+
+// Compute (left * right) mod p for the secp256k1 prime.
+UInt256 uint256_fp_k1_mul(UInt256 left, UInt256 right) {
+  return fp_mul(fp_k1_reduce, left, right);
+}
+
+// Compute (val * val) mod p for the secp256k1 prime.
+UInt256 uint256_fp_k1_sqr(UInt256 val) {
+  return fp_sqr(fp_k1_reduce, val);
+}
+
+// Compute val^-1 mod p for the secp256k1 prime (zero maps to zero).
+UInt256 uint256_fp_k1_inv(UInt256 val) {
+  return fp_inv(FP_K1_P, val);
+}
+
+// Compute (left + right) mod p for the P-256 prime.
+UInt256 uint256_fp_p256_add(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], result[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  fp_add(FP_P256_P, a, b, result);
+  return uint256_from_limbs(result);
+}
+
+// Compute (left - right) mod p for the P-256 prime.
+UInt256 uint256_fp_p256_sub(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4], result[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  fp_sub(FP_P256_P, a, b, result);
+  return uint256_from_limbs(result);
+}
+
+// Compute (left * right) mod p for the P-256 prime.
+UInt256 uint256_fp_p256_mul(UInt256 left, UInt256 right) {
+  return fp_mul(fp_p256_reduce, left, right);
+}
+
+// Compute (val * val) mod p for the P-256 prime.
+UInt256 uint256_fp_p256_sqr(UInt256 val) {
+  return fp_sqr(fp_p256_reduce, val);
+}
+
+// Compute val^-1 mod p for the P-256 prime (zero maps to zero).
+UInt256 uint256_fp_p256_inv(UInt256 val) {
+  return fp_inv(FP_P256_P, val);
+}
+
+// Greatest common divisor and modular inverse. The inverse uses the
+// Bernstein-Yang "safegcd" divstep algorithm (as in libsecp256k1):
+// values are held as five signed 62-bit limbs, and batches of 62
+// divsteps are run on the low limb alone, accumulating a 2x2 matrix
+// that is then applied to the full values with 128-bit sums.
+typedef struct {
+  int64_t v[5];
+} Signed62;
+
+// Transition matrix for a batch of divsteps, scaled by 2^62.
+typedef struct {
+  int64_t u, v, q, r;
+} DivstepMatrix;
+
+// Signed 128-bit accumulator as two's complement (hi:lo).
+typedef struct {
+  uint64_t lo, hi;
+} Acc128;
+
+#define M62 (UINT64_MAX >> 2)
+
+// Add a * b to the accumulator. The unsigned product of the two's
+// complement bit patterns is corrected in the high word for each
+// negative factor.
+static inline void acc_mul_add(Acc128 *acc, int64_t a, int64_t b) {
+  uint64_t hi;
+  uint64_t lo = mul_64x64((uint64_t)a, (uint64_t)b, &hi);
+  hi -= ((uint64_t)(a >> 63) & (uint64_t)b) + ((uint64_t)(b >> 63) & (uint64_t)a);
+  acc->lo += lo;
+  acc->hi += hi + (acc->lo < lo);
+}
+
+// Arithmetic right shift of the accumulator by 62 bits.
+static inline void acc_shr62(Acc128 *acc) {
+  acc->lo = (acc->lo >> 62) | (acc->hi << 2);
+  acc->hi = (uint64_t)((int64_t)acc->hi >> 62);
+}
+
+static void limbs_to_signed62(const uint64_t a[4], Signed62 *out) {
+  for (int i = 0; i < 5; i++) {
+    out->v[i] = (int64_t)limbs_extract(a, 62 * (unsigned)i, 62);
+  }
+}
+
+// Convert back a value whose limbs are all in [0, 2^62).
+static void signed62_to_limbs(const Signed62 *a, uint64_t out[4]) {
+  const uint64_t *v = (const uint64_t *)a->v;
+  out[0] = v[0] | v[1] << 62;
+  out[1] = v[1] >> 2 | v[2] << 60;
+  out[2] = v[2] >> 4 | v[3] << 58;
+  out[3] = v[3] >> 6 | v[4] << 56;
+}
+
+// Modulus in signed 62-bit form plus its inverse mod 2^62.
+typedef struct {
+  Signed62 mod;
+  uint64_t modInv62;
+} ModinvInfo;
+
+static void modinv_info_init(ModinvInfo *info, const uint64_t mod[4]) {
+  limbs_to_signed62(mod, &info->mod);
+  uint64_t inv = mod[0];
+  for (int i = 0; i < 5; i++) {
+    inv *= 2 - mod[0] * inv;
+  }
+  info->modInv62 = inv & M62;
+}
+
+// Run 59 constant-time divsteps on the low bits of f and g. zeta is
+// -(delta + 1/2) for the half-delta variant of divstep, which needs
+// only 590 steps for 256-bit inputs. The matrix starts at 8 = 2^3 so
+// the result is scaled by 2^62 like the variable-time version.
+static int64_t divsteps_59(int64_t zeta, uint64_t f, uint64_t g, DivstepMatrix *t) {
+  uint64_t u = 8, v = 0, q = 0, r = 8;
+  for (int i = 3; i < 62; i++) {
+    // Masks for zeta < 0 and g odd
+    uint64_t neg = ct_barrier((uint64_t)(zeta >> 63));
+    uint64_t odd = ct_barrier(0 - (g & 1));
+    uint64_t x = (f ^ neg) - neg;
+    uint64_t y = (u ^ neg) - neg;
+    uint64_t z = (v ^ neg) - neg;
+    g += x & odd;
+    q += y & odd;
+    r += z & odd;
+    // When both hold, zeta becomes -zeta - 2 and f, u, v pick up the
+    // new g, q, r (swapping the roles of f and g); otherwise zeta - 1
+    neg &= odd;
+    zeta = (zeta ^ (int64_t)neg) - 1;
+    f += g & neg;
+    u += q & neg;
+    v += r & neg;
+    g >>= 1;
+    u <<= 1;
+    v <<= 1;
+  }
+  t->u = (int64_t)u;
+  t->v = (int64_t)v;
+  t->q = (int64_t)q;
+  t->r = (int64_t)r;
+  return zeta;
+}
+
+// Run 62 divsteps on the low bits of f and g, skipping runs of zero
+// bits in g at once and cancelling several bits of g per step. eta is
+// -delta for the original divstep.
+static int64_t divsteps_62_var(int64_t eta, uint64_t f, uint64_t g, DivstepMatrix *t) {
+  uint64_t u = 1, v = 0, q = 0, r = 1;
+  int i = 62;
+  for (;;) {
+    // A sentinel bit stops the zero count at i
+    int zeros = ctz_64(g | (UINT64_MAX << i));
+    g >>= zeros;
+    u <<= zeros;
+    v <<= zeros;
+    eta -= zeros;
+    i -= zeros;
+    if (i == 0) {
+      break;
+    }
+    int limit;
+    uint64_t w, m;
+    if (eta < 0) {
+      uint64_t tmp;
+      eta = -eta;
+      tmp = f;
+      f = g;
+      g = 0 - tmp;
+      tmp = u;
+      u = q;
+      q = 0 - tmp;
+      tmp = v;
+      v = r;
+      r = 0 - tmp;
+      // Cancel up to 6 bits of g with one multiple of f
+      limit = (int)eta + 1 > i ? i : (int)eta + 1;
+      m = (UINT64_MAX >> (64 - limit)) & 63;
+      w = (f * g * (f * f - 2)) & m;
+    } else {
+      // Cancel up to 4 bits, as eta tends to be small here
+      limit = (int)eta + 1 > i ? i : (int)eta + 1;
+      m = (UINT64_MAX >> (64 - limit)) & 15;
+      w = f + (((f + 1) & 4) << 1);
+      w = (0 - w * g) & m;
+    }
+    g += f * w;
+    q += u * w;
+    r += v * w;
+  }
+  t->u = (int64_t)u;
+  t->v = (int64_t)v;
+  t->q = (int64_t)q;
+  t->r = (int64_t)r;
+  return eta;
+}
+
+// Apply the matrix to the coefficients: [d, e] = t [d, e] / 2^62 mod
+// the modulus. A multiple of the modulus is added first so the low 62
+// bits are zero and the division is exact. d and e stay in
+// (-2 * mod, mod).
+static void update_de(Signed62 *d, Signed62 *e, const DivstepMatrix *t, const ModinvInfo *info) {
+  const int64_t *m = info->mod.v;
+  int64_t sd = d->v[4] >> 63, se = e->v[4] >> 63;
+  int64_t md = (t->u & sd) + (t->v & se);
+  int64_t me = (t->q & sd) + (t->r & se);
+  Acc128 cd = {0, 0}, ce = {0, 0};
+  acc_mul_add(&cd, t->u, d->v[0]);
+  acc_mul_add(&cd, t->v, e->v[0]);
+  acc_mul_add(&ce, t->q, d->v[0]);
+  acc_mul_add(&ce, t->r, e->v[0]);
+  md -= (int64_t)((info->modInv62 * cd.lo + (uint64_t)md) & M62);
+  me -= (int64_t)((info->modInv62 * ce.lo + (uint64_t)me) & M62);
+  acc_mul_add(&cd, m[0], md);
+  acc_mul_add(&ce, m[0], me);
+  acc_shr62(&cd);
+  acc_shr62(&ce);
+  for (int i = 1; i < 5; i++) {
+    acc_mul_add(&cd, t->u, d->v[i]);
+    acc_mul_add(&cd, t->v, e->v[i]);
+    acc_mul_add(&ce, t->q, d->v[i]);
+    acc_mul_add(&ce, t->r, e->v[i]);
+    acc_mul_add(&cd, m[i], md);
+    acc_mul_add(&ce, m[i], me);
+    d->v[i - 1] = (int64_t)(cd.lo & M62);
+    e->v[i - 1] = (int64_t)(ce.lo & M62);
+    acc_shr62(&cd);
+    acc_shr62(&ce);
+  }
+  d->v[4] = (int64_t)cd.lo;
+  e->v[4] = (int64_t)ce.lo;
+}
+
+// Apply the matrix to f and g: [f, g] = t [f, g] / 2^62 (exact).
+static void update_fg(Signed62 *f, Signed62 *g, const DivstepMatrix *t) {
+  Acc128 cf = {0, 0}, cg = {0, 0};
+  acc_mul_add(&cf, t->u, f->v[0]);
+  acc_mul_add(&cf, t->v, g->v[0]);
+  acc_mul_add(&cg, t->q, f->v[0]);
+  acc_mul_add(&cg, t->r, g->v[0]);
+  acc_shr62(&cf);
+  acc_shr62(&cg);
+  for (int i = 1; i < 5; i++) {
+    acc_mul_add(&cf, t->u, f->v[i]);
+    acc_mul_add(&cf, t->v, g->v[i]);
+    acc_mul_add(&cg, t->q, f->v[i]);
+    acc_mul_add(&cg, t->r, g->v[i]);
+    f->v[i - 1] = (int64_t)(cf.lo & M62);
+    g->v[i - 1] = (int64_t)(cg.lo & M62);
+    acc_shr62(&cf);
+    acc_shr62(&cg);
+  }
+  f->v[4] = (int64_t)cf.lo;
+  g->v[4] = (int64_t)cg.lo;
+}
+
+// Bring d from (-2 * mod, mod) into [0, mod), negating it if sign (the
+// top limb of f) is negative, without branching.
+static void normalize_62(Signed62 *d, int64_t sign, const ModinvInfo *info) {
+  int64_t *r = d->v;
+  int64_t add = (int64_t)ct_barrier((uint64_t)(r[4] >> 63));
+  int64_t neg = (int64_t)ct_barrier((uint64_t)(sign >> 63));
+  for (int i = 0; i < 5; i++) {
+    r[i] += info->mod.v[i] & add;
+    r[i] = (r[i] ^ neg) - neg;
+  }
+  for (int pass = 0; pass < 2; pass++) {
+    for (int i = 0; i < 4; i++) {
+      r[i + 1] += r[i] >> 62;
+      r[i] &= (int64_t)M62;
+    }
+    if (pass == 0) {
+      add = (int64_t)ct_barrier((uint64_t)(r[4] >> 63));
+      for (int i = 0; i < 5; i++) {
+        r[i] += info->mod.v[i] & add;
+      }
+    }
+  }
+}
+
+// Return an all-ones mask if f is 1 or -1 (so the inputs were coprime).
+static uint64_t signed62_is_unit(const Signed62 *f) {
+  uint64_t plus = (uint64_t)f->v[0] ^ 1, minus = ((uint64_t)f->v[0] ^ M62) | ((uint64_t)f->v[4] ^ UINT64_MAX);
+  plus |= (uint64_t)f->v[4];
+  for (int i = 1; i < 4; i++) {
+    plus |= (uint64_t)f->v[i];
+    minus |= (uint64_t)f->v[i] ^ M62;
+  }
+  return mask_if(plus == 0) | mask_if(minus == 0);
+}
+
+// Compute the greatest common divisor with the binary (Stein) method:
+// strip the shared factors of two, then repeatedly subtract the smaller
+// odd value from the larger and strip the new zero bits.
+UInt256 uint256_gcd(UInt256 left, UInt256 right) {
+  uint64_t a[4], b[4];
+  uint256_to_limbs(&left, a);
+  uint256_to_limbs(&right, b);
+  if (limbs_count(a, 4) == 0) {
+    return right;
+  }
+  if (limbs_count(b, 4) == 0) {
+    return left;
+  }
+  unsigned shift = uint256_ctz(uint256_or(left, right));
+  limbs_shr(a, uint256_ctz(left), a);
+  do {
+    limbs_shr(b, uint256_ctz(uint256_from_limbs(b)), b);
+    if (limbs_cmp(a, b) > 0) {
+      uint64_t tmp[4];
+      memcpy(tmp, a, sizeof(tmp));
+      memcpy(a, b, sizeof(tmp));
+      memcpy(b, tmp, sizeof(tmp));
+    }
+    limbs_sub(b, b, a);
+  } while (limbs_count(b, 4) != 0);
+  limbs_shl(a, shift, a);
+  return uint256_from_limbs(a);
+}
+
+// Invert modulo an even modulus with the extended Euclidean algorithm,
+// keeping the Bezout coefficient reduced mod the modulus.
+static UInt256 modinv_euclid(UInt256 val, UInt256 mod) {
+  uint64_t m[4], t0[4] = {0}, t1[4] = {1, 0, 0, 0};
+  uint256_to_limbs(&mod, m);
+  UInt256 r0 = mod, r1 = uint256_mod(val, mod);
+  while (uint256_bit_length(r1) != 0) {
+    UInt256 q, r;
+    uint256_divmod(r0, r1, &q, &r);
+    UInt256 qt = uint256_mulmod(q, uint256_from_limbs(t1), mod);
+    uint64_t qtLimbs[4], t2[4];
+    uint256_to_limbs(&qt, qtLimbs);
+    fp_sub(m, t0, qtLimbs, t2);
+    memcpy(t0, t1, sizeof(t0));
+    memcpy(t1, t2, sizeof(t1));
+    r0 = r1;
+    r1 = r;
+  }
+  if (!uint256_eq(r0, uint256_create_from_u32(1))) {
+    return uint256_create_from_u32(0);
+  }
+  return uint256_from_limbs(t0);
+}
+
+// Compute val^-1 mod mod. Odd moduli use variable-time safegcd, which
+// stops as soon as g reaches zero; even moduli fall back to Euclid.
+// Returns zero if no inverse exists or mod is zero.
+UInt256 uint256_modinv(UInt256 val, UInt256 mod) {
+  if ((mod.data[0] & 1) == 0) {
+    return uint256_bit_length(mod) == 0 ? mod : modinv_euclid(val, mod);
+  }
+  uint64_t m[4], a[4];
+  uint256_to_limbs(&mod, m);
+  val = uint256_mod(val, mod);
+  uint256_to_limbs(&val, a);
+
+  ModinvInfo info;
+  modinv_info_init(&info, m);
+  Signed62 d = {{0}}, e = {{1}}, f = info.mod, g;
+  limbs_to_signed62(a, &g);
+  int64_t eta = -1;
+  for (;;) {
+    DivstepMatrix t;
+    eta = divsteps_62_var(eta, (uint64_t)f.v[0], (uint64_t)g.v[0], &t);
+    update_de(&d, &e, &t, &info);
+    update_fg(&f, &g, &t);
+    if ((g.v[0] | g.v[1] | g.v[2] | g.v[3] | g.v[4]) == 0) {
+      break;
+    }
+  }
+  if (!signed62_is_unit(&f)) {
+    return uint256_create_from_u32(0);
+  }
+  normalize_62(&d, f.v[4], &info);
+  signed62_to_limbs(&d, a);
+  return uint256_from_limbs(a);
+}
+
+// Compute val^-1 mod an odd modulus in constant time: always 590
+// divsteps in ten fixed batches, with masks in place of branches. val
+// must be less than mod. Returns zero if no inverse exists or mod is
+// even.
+UInt256 uint256_ct_modinv(UInt256 val, UInt256 mod) {
+  UInt256 zero = {0};
+  if ((mod.data[0] & 1) == 0) {
+    return zero;
+  }
+  uint64_t m[4], a[4];
+  uint256_to_limbs(&mod, m);
+  uint256_to_limbs(&val, a);
+
+  ModinvInfo info;
+  modinv_info_init(&info, m);
+  Signed62 d = {{0}}, e = {{1}}, f = info.mod, g;
+  limbs_to_signed62(a, &g);
+  int64_t zeta = -1;
+  for (int i = 0; i < 10; i++) {
+    DivstepMatrix t;
+    zeta = divsteps_59(zeta, (uint64_t)f.v[0], (uint64_t)g.v[0], &t);
+    update_de(&d, &e, &t, &info);
+    update_fg(&f, &g, &t);
+  }
+  uint64_t unit = signed62_is_unit(&f);
+  normalize_62(&d, f.v[4], &info);
+  signed62_to_limbs(&d, a);
+  for (int i = 0; i < 4; i++) {
+    a[i] &= unit;
+  }
+  return uint256_from_limbs(a);
+}
+
+// Load vals[i] as limbs, reduced below the modulus if it isn't already.
+static void modinv_batch_load(const ModArith *arith, const UInt256 *val, uint64_t out[4]) {
+  uint256_to_limbs(val, out);
+  if (limbs_cmp(out, arith->mod) >= 0) {
+    uint64_t t[8] = {out[0], out[1], out[2], out[3], 0, 0, 0, 0};
+    limbs_mod_wide(t, arith->mod, out);
+  }
+}
+
+// Invert n values with Montgomery's trick: one inversion of the
+// product of all of them, then two multiplications per value on the
+// way back, 3n multiplications in all. The values never enter or leave
+// Montgomery form. Each product carries a factor R^-1 (R = 2^256, or
+// 1 for an even modulus), so the prefix a[i] = vals[0 .. i - 1] *
+// R^-i, and with b[i] = a[i]^-1:
+//   vals[i]^-1 = a[i] * b[i + 1] * R^-1
+//   b[i]       = vals[i] * b[i + 1] * R^-1
+// which are both single Montgomery products. out must not overlap
+// vals. Returns 1 on success; if any value has no inverse (or mod is
+// zero), every output is zero and 0 is returned.
+int uint256_modinv_batch(UInt256 *out, const UInt256 *vals, size_t n, UInt256 mod) {
+  if (n == 0) {
+    return 1;
+  }
+  if (uint256_bit_length(mod) == 0) {
+    memset(out, 0, n * sizeof(UInt256));
+    return 0;
+  }
+  ModArith arith;
+  modarith_init(&arith, mod);
+  uint64_t acc[4] = {1, 0, 0, 0}, v[4], inv[4];
+
+  // out[i] holds the prefix a[i]
+  for (size_t i = 0; i < n; i++) {
+    out[i] = uint256_from_limbs(acc);
+    modinv_batch_load(&arith, &vals[i], v);
+    modarith_mul(&arith, acc, v, acc);
+  }
+
+  UInt256 total = uint256_modinv(uint256_from_limbs(acc), mod);
+  if (uint256_bit_length(total) == 0) {
+    memset(out, 0, n * sizeof(UInt256));
+    return 0;
+  }
+  uint256_to_limbs(&total, inv);
+
+  // inv is b[i + 1]; peel off one value per step
+  for (size_t i = n; i-- > 0;) {
+    uint64_t prefix[4], result[4];
+    uint256_to_limbs(&out[i], prefix);
+    modinv_batch_load(&arith, &vals[i], v);
+    modarith_mul(&arith, prefix, inv, result);
+    modarith_mul(&arith, v, inv, inv);
+    out[i] = uint256_from_limbs(result);
+  }
+  return 1;
+}
+
+// Return floor(sqrt(val)). A double-precision square root of the top
+// 64 bits gives about 50 correct bits; it's nudged up so it can't be
+// below the root, and then Newton steps x = (x + val / x) / 2 shrink
+// it monotonically until they stop decreasing, which takes two or
+// three divisions.
+UInt256 uint256_isqrt(UInt256 val) {
+  uint64_t a[4];
+  uint256_to_limbs(&val, a);
+  int len = limbs_bit_length(a);
+  if (len == 0) {
+    return val;
+  }
+  int shift = len > 64 ? len - 64 : 0;
+  int exp;
+  double frac = frexp(sqrt(ldexp((double)limbs_extract(a, (unsigned)shift, 64), shift)), &exp);
+  uint64_t guess[4] = {(uint64_t)ldexp(frac, 64), 0, 0, 0};
+  UInt256 x = uint256_from_limbs(guess);
+  x = exp >= 64 ? uint256_shl(x, (unsigned)(exp - 64)) : uint256_shr(x, (unsigned)(64 - exp));
+  x = uint256_add(x, uint256_add(uint256_shr(x, 50), uint256_create_from_u32(1)));
+
+  for (;;) {
+    UInt256 y = uint256_shr(uint256_add(x, uint256_div(val, x)), 1);
+    if (!uint256_lt(y, x)) {
+      return x;
+    }
+    x = y;
+  }
+}
+
+// Squares mod 64, mod 63, mod 11 and mod 65 (where r and 65 - r are
+// both squares or both not, so only r <= 32 is stored), as bit masks.
+#define SQUARES_MOD_64 UINT64_C(0x0202021202030213)
+#define SQUARES_MOD_63 UINT64_C(0x0402483012450293)
+#define SQUARES_MOD_65 UINT64_C(0x66014613)
+#define SQUARES_MOD_11 0x23BU
+
+// Return 1 if val is a perfect square, storing its root in *root (which
+// may be NULL). Residues mod 64 and mod 63 * 65 * 11 rule out all but
+// about 1 in 125 non-squares before the square root is computed.
+int uint256_is_square(UInt256 val, UInt256 *root) {
+  if (!((SQUARES_MOD_64 >> (val.data[0] & 63)) & 1)) {
+    return 0;
+  }
+  uint64_t r = 0;
+  for (int i = 7; i >= 0; i--) {
+    r = ((r << 32) | val.data[i]) % 45045;
+  }
+  unsigned r65 = (unsigned)(r % 65);
+  if (!((SQUARES_MOD_63 >> (r % 63)) & 1) || !((SQUARES_MOD_65 >> (r65 <= 32 ? r65 : 65 - r65)) & 1) ||
+      !((SQUARES_MOD_11 >> (r % 11)) & 1)) {
+    return 0;
+  }
+  UInt256 s = uint256_isqrt(val);
+  if (!uint256_eq(uint256_mul(s, s), val)) {
+    return 0;
+  }
+  if (root != NULL) {
+    *root = s;
+  }
+  return 1;
+}
+
+// Store left[i] + right[i] in out[i] for each of the n elements. out
+// may be the same array as left or right.
+void uint256_add_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t a[4], b[4];
+    uint256_to_limbs(&left[i], a);
+    uint256_to_limbs(&right[i], b);
+    limbs_add(a, a, b);
+    out[i] = uint256_from_limbs(a);
+  }
+}
+
+// Store left[i] - right[i] in out[i] for each of the n elements. out
+// may be the same array as left or right.
+void uint256_sub_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t a[4], b[4];
+    uint256_to_limbs(&left[i], a);
+    uint256_to_limbs(&right[i], b);
+    limbs_sub(a, a, b);
+    out[i] = uint256_from_limbs(a);
+  }
+}
+
+// Store the negation of val[i] in out[i] for each of the n elements.
+// out may be the same array as val.
+void uint256_negate_batch(UInt256 *out, const UInt256 *val, size_t n) {
+  uint64_t zero[4] = {0};
+  for (size_t i = 0; i < n; i++) {
+    uint64_t a[4];
+    uint256_to_limbs(&val[i], a);
+    limbs_sub(a, zero, a);
+    out[i] = uint256_from_limbs(a);
+  }
+}
+
+// Copy n values into structure-of-arrays layout.
+void uint256_soa_load(const UInt256SoA *dst, const UInt256 *src, size_t n) {
+  for (size_t j = 0; j < n; j++) {
+    for (int i = 0; i < 8; i++) {
+      dst->words[i][j] = src[j].data[i];
+    }
+  }
+}
+
+// Copy n values out of structure-of-arrays layout.
+void uint256_soa_store(UInt256 *dst, const UInt256SoA *src, size_t n) {
+  for (size_t j = 0; j < n; j++) {
+    for (int i = 0; i < 8; i++) {
+      dst[j].data[i] = src->words[i][j];
+    }
+  }
+}
+
+// Number of values the SoA kernels process together. Carries for a
+// block live in a small stack array while the kernel sweeps the eight
+// word arrays, so every inner loop is a plain element-wise loop that
+// the compiler can vectorize.
+#define SOA_BLOCK 256
+
+// Element-wise out = a + b over n values in SoA layout.
+SOA_KERNEL void soa_add_kernel(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n) {
+  uint32_t carry[SOA_BLOCK];
+  for (size_t start = 0; start < n; start += SOA_BLOCK) {
+    size_t len = n - start < SOA_BLOCK ? n - start : SOA_BLOCK;
+    for (size_t j = 0; j < len; j++) {
+      carry[j] = 0;
+    }
+    for (int i = 0; i < 8; i++) {
+      const uint32_t *aw = a->words[i] + start;
+      const uint32_t *bw = b->words[i] + start;
+      uint32_t *ow = out->words[i] + start;
+      for (size_t j = 0; j < len; j++) {
+        uint64_t sum = (uint64_t)aw[j] + bw[j] + carry[j];
+        ow[j] = (uint32_t)sum;
+        carry[j] = (uint32_t)(sum >> 32);
+      }
+    }
+  }
+}
+
+// Element-wise out = a - b over n values in SoA layout.
+SOA_KERNEL void soa_sub_kernel(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n) {
+  uint32_t borrow[SOA_BLOCK];
+  for (size_t start = 0; start < n; start += SOA_BLOCK) {
+    size_t len = n - start < SOA_BLOCK ? n - start : SOA_BLOCK;
+    for (size_t j = 0; j < len; j++) {
+      borrow[j] = 0;
+    }
+    for (int i = 0; i < 8; i++) {
+      const uint32_t *aw = a->words[i] + start;
+      const uint32_t *bw = b->words[i] + start;
+      uint32_t *ow = out->words[i] + start;
+      for (size_t j = 0; j < len; j++) {
+        uint64_t diff = (uint64_t)aw[j] - bw[j] - borrow[j];
+        ow[j] = (uint32_t)diff;
+        borrow[j] = (uint32_t)(diff >> 63);
+      }
+    }
+  }
+}
+
+// Element-wise out = -a over n values in SoA layout.
+SOA_KERNEL void soa_negate_kernel(const UInt256SoA *out, const UInt256SoA *a, size_t n) {
+  uint32_t borrow[SOA_BLOCK];
+  for (size_t start = 0; start < n; start += SOA_BLOCK) {
+    size_t len = n - start < SOA_BLOCK ? n - start : SOA_BLOCK;
+    for (size_t j = 0; j < len; j++) {
+      borrow[j] = 0;
+    }
+    for (int i = 0; i < 8; i++) {
+      const uint32_t *aw = a->words[i] + start;
+      uint32_t *ow = out->words[i] + start;
+      for (size_t j = 0; j < len; j++) {
+        uint64_t diff = 0 - (uint64_t)aw[j] - borrow[j];
+        ow[j] = (uint32_t)diff;
+        borrow[j] = (uint32_t)(diff >> 63);
+      }
+    }
+  }
+}
+
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+__attribute__((target("avx2")))
+static void soa_add_avx2(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n) {
+  soa_add_kernel(out, a, b, n);
+}
+
+__attribute__((target("avx2")))
+static void soa_sub_avx2(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n) {
+  soa_sub_kernel(out, a, b, n);
+}
+
+__attribute__((target("avx2")))
+static void soa_negate_avx2(const UInt256SoA *out, const UInt256SoA *a, size_t n) {
+  soa_negate_kernel(out, a, n);
+}
+
+// Return nonzero if the running CPU supports AVX2.
+static int cpu_has_avx2(void) {
+  static int cached = -1;
+  if (cached < 0) {
+    __builtin_cpu_init();
+    cached = __builtin_cpu_supports("avx2") != 0;
+  }
+  return cached;
+}
+#endif
+
+// Store a[j] + b[j] in out[j] for n values in SoA layout. out may be
+// the same as a or b.
+void uint256_soa_add(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n) {
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+  if (cpu_has_avx2()) {
+    soa_add_avx2(out, a, b, n);
+    return;
+  }
+#endif
+  soa_add_kernel(out, a, b, n);
+}
+
+// Store a[j] - b[j] in out[j] for n values in SoA layout. out may be
+// the same as a or b.
+void uint256_soa_sub(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n) {
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+  if (cpu_has_avx2()) {
+    soa_sub_avx2(out, a, b, n);
+    return;
+  }
+#endif
+  soa_sub_kernel(out, a, b, n);
+}
+
+// Store -a[j] in out[j] for n values in SoA layout. out may be the
+// same as a.
+void uint256_soa_negate(const UInt256SoA *out, const UInt256SoA *a, size_t n) {
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+  if (cpu_has_avx2()) {
+    soa_negate_avx2(out, a, n);
+    return;
+  }
+#endif
+  soa_negate_kernel(out, a, n);
+}
+
+// Parse one 64-digit record with no prefix. Returns 0 if any character
+// isn't a hex digit. Invalid characters are collected with an OR rather
+// than a branch per digit.
+static int hex_record_parse(const char *text, UInt256 *out) {
+  uint32_t bad = 0;
+  for (int i = 0; i < 8; i++) {
+    const char *chunk = text + 8 * (7 - i);
+    uint32_t w = 0;
+    for (int j = 0; j < 8; j++) {
+      uint32_t digit = hexDigitValue[(unsigned char)chunk[j]];
+      bad |= digit;
+      w = (w << 4) | (digit & 0xF);
+    }
+    out->data[i] = w;
+  }
+  return (bad & 0xF0) == 0;
+}
+
+// Format one value as exactly 64 digits, with leading zeros.
+static void hex_record_format(const UInt256 *val, char *text) {
+  for (int i = 0; i < 8; i++) {
+    char *chunk = text + 8 * (7 - i);
+    uint32_t w = val->data[i];
+    for (int j = 7; j >= 0; j--) {
+      chunk[j] = hexDigits[w & 0xF];
+      w >>= 4;
+    }
+  }
+}
+
+#if defined(UINT256_HAVE_AVX2_DISPATCH) && defined(UINT256_LIMBS_ARE_WORDS)
+#define UINT256_HAVE_AVX2_HEX
+
+// Reverse the order of all 32 bytes in v.
+__attribute__((target("avx2")))
+static inline __m256i reverse_bytes_avx2(__m256i v) {
+  const __m256i rev = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                       15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, rev), 0x4E);
+}
+
+// Convert 32 hex characters to their nibble values. Lanes that aren't
+// hex digits are cleared in *valid.
+__attribute__((target("avx2")))
+static inline __m256i hex_nibbles_avx2(__m256i c, __m256i *valid) {
+  __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+  __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                     _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+  __m256i isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+  *valid = _mm256_or_si256(isDigit, isLetter);
+  return _mm256_blendv_epi8(_mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)),
+                            _mm256_sub_epi8(c, _mm256_set1_epi8('0')), isDigit);
+}
+
+// Parse n records with AVX2, stopping at the first invalid one.
+__attribute__((target("avx2")))
+static size_t parse_hex_batch_avx2(UInt256 *out, const char *text, size_t n) {
+  const __m256i pairWeights = _mm256_set1_epi16(0x0110);
+  for (size_t i = 0; i < n; i++) {
+    const char *rec = text + 64 * i;
+    __m256i valid0, valid1;
+    __m256i nib0 = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)rec), &valid0);
+    __m256i nib1 = hex_nibbles_avx2(_mm256_loadu_si256((const __m256i *)(rec + 32)), &valid1);
+    if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1) {
+      return i;
+    }
+    // Each pair of digits becomes 16 * high + low in a 16-bit lane,
+    // then the lanes are packed back to bytes, most significant first.
+    __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(nib0, pairWeights),
+                                        _mm256_maddubs_epi16(nib1, pairWeights));
+    bytes = _mm256_permute4x64_epi64(bytes, 0xD8);
+    _mm256_storeu_si256((__m256i *)out[i].data, reverse_bytes_avx2(bytes));
+  }
+  return n;
+}
+
+// Format n records with AVX2.
+__attribute__((target("avx2")))
+static void format_hex_batch_avx2(char *text, const UInt256 *vals, size_t n) {
+  const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                          '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                          '0', '1', '2', '3', '4', '5', '6', '7',
+                                          '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+  for (size_t i = 0; i < n; i++) {
+    __m256i bytes = reverse_bytes_avx2(_mm256_loadu_si256((const __m256i *)vals[i].data));
+    __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), lowNibble));
+    __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, lowNibble));
+    __m256i first = _mm256_unpacklo_epi8(hi, lo);
+    __m256i second = _mm256_unpackhi_epi8(hi, lo);
+    char *rec = text + 64 * i;
+    _mm256_storeu_si256((__m256i *)rec, _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256((__m256i *)(rec + 32), _mm256_permute2x128_si256(first, second, 0x31));
+  }
+}
+#endif
+
+// Parse n fixed-width records of 64 hex digits each.
+size_t uint256_parse_hex_batch(UInt256 *out, const char *text, size_t n) {
+#ifdef UINT256_HAVE_AVX2_HEX
+  if (cpu_has_avx2()) {
+    return parse_hex_batch_avx2(out, text, n);
+  }
+#endif
+  for (size_t i = 0; i < n; i++) {
+    if (!hex_record_parse(text + 64 * i, &out[i])) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// Format n values as fixed-width records of 64 hex digits each.
+void uint256_format_hex_batch(char *text, const UInt256 *vals, size_t n) {
+#ifdef UINT256_HAVE_AVX2_HEX
+  if (cpu_has_avx2()) {
+    format_hex_batch_avx2(text, vals, n);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; i++) {
+    hex_record_format(&vals[i], text + 64 * i);
+  }
+}
+
+// Return the index of the first of the n values that compares as sign
+// (1 for largest, -1 for smallest) against every other value.
+static size_t extreme_index(const UInt256 *vals, size_t n, int sign) {
+  size_t best = 0;
+  uint64_t bestLimbs[4];
+  uint256_to_limbs(&vals[0], bestLimbs);
+  for (size_t i = 1; i < n; i++) {
+    uint64_t limbs[4];
+    uint256_to_limbs(&vals[i], limbs);
+    if (limbs_cmp(limbs, bestLimbs) == sign) {
+      best = i;
+      memcpy(bestLimbs, limbs, sizeof(limbs));
+    }
+  }
+  return best;
+}
+
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+// Transpose eight values, one per register, so that r[k] holds word k
+// of all eight.
+__attribute__((target("avx2")))
+static inline void transpose_8x8_avx2(__m256i r[8]) {
+  __m256i t[8], u[8];
+  for (int i = 0; i < 8; i += 2) {
+    t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  for (int i = 0; i < 8; i += 4) {
+    u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+    u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+    u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+    u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  for (int i = 0; i < 4; i++) {
+    r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+    r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+  }
+}
+
+// Load the block of eight values starting at vals, transposed, with
+// the sign bit of each word flipped so signed compares order them as
+// unsigned.
+__attribute__((target("avx2")))
+static inline void load_block_avx2(const UInt256 *vals, __m256i w[8]) {
+  const __m256i flip = _mm256_set1_epi32((int)0x80000000U);
+  for (int i = 0; i < 8; i++) {
+    w[i] = _mm256_loadu_si256((const __m256i *)vals[i].data);
+  }
+  transpose_8x8_avx2(w);
+  for (int k = 0; k < 8; k++) {
+    w[k] = _mm256_xor_si256(w[k], flip);
+  }
+}
+
+// Find the extreme value with each of eight lanes keeping the best of
+// every eighth value. A lane's full compare is built from the most
+// significant word down: the candidate wins if it's ahead on some word
+// and tied on every word above it. Lanes only move on a strict win,
+// so each keeps its first occurrence, and the lane winners (plus the
+// values past the last full block) are settled by index.
+__attribute__((target("avx2")))
+static size_t extreme_index_avx2(const UInt256 *vals, size_t n, int sign) {
+  size_t blocks = n / 8;
+  if (blocks > UINT32_MAX) {
+    blocks = UINT32_MAX;
+  }
+  if (blocks < 2) {
+    return extreme_index(vals, n, sign);
+  }
+  __m256i best[8], cand[8];
+  __m256i bestBlock = _mm256_setzero_si256();
+  load_block_avx2(vals, best);
+  for (size_t b = 1; b < blocks; b++) {
+    load_block_avx2(vals + 8 * b, cand);
+    __m256i win = _mm256_setzero_si256();
+    __m256i tied = _mm256_set1_epi32(-1);
+    for (int k = 7; k >= 0; k--) {
+      __m256i ahead = sign > 0 ? _mm256_cmpgt_epi32(cand[k], best[k]) : _mm256_cmpgt_epi32(best[k], cand[k]);
+      win = _mm256_or_si256(win, _mm256_and_si256(tied, ahead));
+      tied = _mm256_and_si256(tied, _mm256_cmpeq_epi32(cand[k], best[k]));
+    }
+    for (int k = 0; k < 8; k++) {
+      best[k] = _mm256_blendv_epi8(best[k], cand[k], win);
+    }
+    bestBlock = _mm256_blendv_epi8(bestBlock, _mm256_set1_epi32((int)(uint32_t)b), win);
+  }
+
+  uint32_t lanes[8];
+  _mm256_storeu_si256((__m256i *)lanes, bestBlock);
+  size_t winner = 8 * (size_t)lanes[0];
+  uint64_t winLimbs[4];
+  uint256_to_limbs(&vals[winner], winLimbs);
+  for (size_t j = 1; j < 8; j++) {
+    size_t i = 8 * (size_t)lanes[j] + j;
+    uint64_t limbs[4];
+    uint256_to_limbs(&vals[i], limbs);
+    int c = limbs_cmp(limbs, winLimbs);
+    if (c == sign || (c == 0 && i < winner)) {
+      winner = i;
+      memcpy(winLimbs, limbs, sizeof(limbs));
+    }
+  }
+  for (size_t i = 8 * blocks; i < n; i++) {
+    uint64_t limbs[4];
+    uint256_to_limbs(&vals[i], limbs);
+    if (limbs_cmp(limbs, winLimbs) == sign) {
+      winner = i;
+      memcpy(winLimbs, limbs, sizeof(limbs));
+    }
+  }
+  return winner;
+}
+#endif
+
+// Find the largest value, comparing eight at a time with AVX2 when the
+// CPU supports it. With no values there is nothing to read, so return
+// n (0), the same not-found result as uint256_lower_bound.
+size_t uint256_max_index(const UInt256 *vals, size_t n) {
+  if (n == 0) {
+    return 0;
+  }
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+  if (cpu_has_avx2()) {
+    return extreme_index_avx2(vals, n, 1);
+  }
+#endif
+  return extreme_index(vals, n, 1);
+}
+
+// Find the smallest value, the same way as uint256_max_index.
+size_t uint256_min_index(const UInt256 *vals, size_t n) {
+  if (n == 0) {
+    return 0;
+  }
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+  if (cpu_has_avx2()) {
+    return extreme_index_avx2(vals, n, -1);
+  }
+#endif
+  return extreme_index(vals, n, -1);
+}
+
+// Return 1 if *a is less than *b, without branching.
+static int vals_less(const UInt256 *a, const UInt256 *b) {
+  uint64_t x[4], y[4], diff[4];
+  uint256_to_limbs(a, x);
+  uint256_to_limbs(b, y);
+  return (int)limbs_sub(diff, x, y);
+}
+
+// Byte byteIndex of val, where byte 0 is the least significant.
+static inline unsigned val_byte(const UInt256 *val, int byteIndex) {
+  return (val->data[byteIndex / 4] >> (8 * (byteIndex % 4))) & 0xFF;
+}
+
+// Buckets this small are finished with insertion sort rather than
+// another radix pass.
+#define RADIX_SORT_CUTOFF 32
+
+// Sort n values with insertion sort.
+static void insertion_sort(UInt256 *vals, size_t n) {
+  for (size_t i = 1; i < n; i++) {
+    UInt256 v = vals[i];
+    size_t j = i;
+    while (j > 0 && vals_less(&v, &vals[j - 1])) {
+      vals[j] = vals[j - 1];
+      j--;
+    }
+    vals[j] = v;
+  }
+}
+
+// Permute n values in place so they are grouped by byte byteIndex in
+// ascending order (one American flag sort pass). Bucket b ends up in
+// [start[b], start[b + 1]).
+static void radix_partition(UInt256 *vals, size_t n, int byteIndex, size_t start[257]) {
+  size_t next[256] = {0};
+  for (size_t i = 0; i < n; i++) {
+    next[val_byte(&vals[i], byteIndex)]++;
+  }
+  start[0] = 0;
+  for (int b = 0; b < 256; b++) {
+    start[b + 1] = start[b] + next[b];
+    next[b] = start[b];
+  }
+
+  // Walk each bucket, swapping every misplaced value into the next free
+  // slot of its own bucket until the slot holds a value that belongs.
+  for (int b = 0; b < 256; b++) {
+    while (next[b] < start[b + 1]) {
+      UInt256 v = vals[next[b]];
+      unsigned d = val_byte(&v, byteIndex);
+      while (d != (unsigned)b) {
+        UInt256 displaced = vals[next[d]];
+        vals[next[d]++] = v;
+        v = displaced;
+        d = val_byte(&v, byteIndex);
+      }
+      vals[next[b]++] = v;
+    }
+  }
+}
+
+// MSD radix sort of n values whose bytes above byteIndex are all equal.
+static void radix_sort(UInt256 *vals, size_t n, int byteIndex) {
+  if (n <= RADIX_SORT_CUTOFF) {
+    insertion_sort(vals, n);
+    return;
+  }
+  size_t start[257];
+  radix_partition(vals, n, byteIndex, start);
+  if (byteIndex == 0) {
+    return;
+  }
+  for (int b = 0; b < 256; b++) {
+    size_t len = start[b + 1] - start[b];
+    if (len > 1) {
+      radix_sort(vals + start[b], len, byteIndex - 1);
+    }
+  }
+}
+
+// Sort n values in ascending order, in place.
+void uint256_sort(UInt256 *vals, size_t n) {
+  radix_sort(vals, n, 31);
+}
+
+// Shared state for the threads of uint256_sort_parallel. After the
+// first pass, the buckets of byte byteIndex are independent, and each
+// thread repeatedly claims the next unsorted one.
+typedef struct {
+  UInt256 *vals;
+  size_t start[257];
+  int byteIndex;
+  int nextBucket;
+  pthread_mutex_t lock;
+} SortJob;
+
+static void *sort_worker(void *arg) {
+  SortJob *job = arg;
+  for (;;) {
+    pthread_mutex_lock(&job->lock);
+    int b = job->nextBucket++;
+    pthread_mutex_unlock(&job->lock);
+    if (b >= 256) {
+      return NULL;
+    }
+    size_t len = job->start[b + 1] - job->start[b];
+    if (len > 1 && job->byteIndex > 0) {
+      radix_sort(job->vals + job->start[b], len, job->byteIndex - 1);
+    }
+  }
+}
+
+// Return the index of the most significant byte where the n values
+// don't all agree, or -1 if they are all equal.
+static int top_differing_byte(const UInt256 *vals, size_t n) {
+  UInt256 diff = {0};
+  for (size_t i = 1; i < n; i++) {
+    for (int w = 0; w < 8; w++) {
+      diff.data[w] |= vals[i].data[w] ^ vals[0].data[w];
+    }
+  }
+  unsigned bits = uint256_bit_length(diff);
+  return bits == 0 ? -1 : (int)((bits - 1) / 8);
+}
+
+// Sort n values in ascending order using up to numThreads threads.
+// The first pass partitions on the most significant byte that differs
+// between the values, so keys sharing their top bytes (anything below
+// 2^248, say) still spread across the threads.
+unsigned uint256_sort_parallel(UInt256 *vals, size_t n, unsigned numThreads) {
+  if (numThreads <= 1 || n <= RADIX_SORT_CUTOFF) {
+    uint256_sort(vals, n);
+    return 1;
+  }
+  if (numThreads > 256) {
+    numThreads = 256;
+  }
+  int byteIndex = top_differing_byte(vals, n);
+  if (byteIndex < 0) {
+    return 1;
+  }
+
+  SortJob job;
+  job.vals = vals;
+  job.byteIndex = byteIndex;
+  job.nextBucket = 0;
+  pthread_mutex_init(&job.lock, NULL);
+  radix_partition(vals, n, byteIndex, job.start);
+  unsigned buckets = 0;
+  for (int b = 0; b < 256; b++) {
+    buckets += job.start[b + 1] > job.start[b];
+  }
+
+  // The calling thread works too; if a thread can't be started, the
+  // ones that were still drain every bucket.
+  pthread_t threads[255];
+  unsigned started = 0;
+  while (started < numThreads - 1 && pthread_create(&threads[started], NULL, sort_worker, &job) == 0) {
+    started++;
+  }
+  sort_worker(&job);
+  for (unsigned i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  pthread_mutex_destroy(&job.lock);
+  return buckets;
+}
+
+// Find the first of the n sorted values that isn't less than key. The
+// range halves every step with a conditional move instead of a branch,
+// so there are no mispredictions.
+size_t uint256_lower_bound(const UInt256 *sorted, size_t n, UInt256 key) {
+  if (n == 0) {
+    return 0;
+  }
+  const UInt256 *base = sorted;
+  while (n > 1) {
+    size_t half = n / 2;
+    base = vals_less(&base[half], &key) ? base + half : base;
+    n -= half;
+  }
+  return (size_t)(base - sorted) + (size_t)vals_less(base, &key);
+}
+
+// Fill the subtree rooted at 1-based node k with sorted[i], sorted[i + 1],
+// ... in order, returning the index of the next unused sorted value.
+static size_t eytzinger_fill(UInt256 *tree, const UInt256 *sorted, size_t n, size_t i, size_t k) {
+  if (k <= n) {
+    i = eytzinger_fill(tree, sorted, n, i, 2 * k);
+    tree[k - 1] = sorted[i++];
+    i = eytzinger_fill(tree, sorted, n, i, 2 * k + 1);
+  }
+  return i;
+}
+
+// Lay out n sorted values in Eytzinger (breadth-first) order.
+void uint256_eytzinger_build(UInt256 *tree, const UInt256 *sorted, size_t n) {
+  eytzinger_fill(tree, sorted, n, 0, 1);
+}
+
+// Find the smallest value in an Eytzinger tree that isn't less than key.
+// The descent always runs to a leaf, and the answer is the last node
+// where it went left. Stripping the trailing right turns (one bits)
+// plus that final left turn from the path recovers it.
+size_t uint256_eytzinger_lower_bound(const UInt256 *tree, size_t n, UInt256 key) {
+  size_t k = 1;
+  while (k <= n) {
+    k = 2 * k + (size_t)vals_less(&tree[k - 1], &key);
+  }
+#if defined(__GNUC__)
+  k >>= __builtin_ffsll((long long)~k);
+#else
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+#endif
+  return k == 0 ? n : k - 1;
+}
+
+// Fold two 64-bit words into one by multiplying them and XORing the
+// halves of the 128-bit product.
+static inline uint64_t hash_fold(uint64_t a, uint64_t b) {
+  uint64_t hi;
+  uint64_t lo = mul_64x64(a, b, &hi);
+  return lo ^ hi;
+}
+
+// Hash a value by folding its limbs pairwise. The two folds are
+// independent, so the multiplies overlap, and a final fold mixes
+// every input bit into every output bit.
+uint64_t uint256_hash(UInt256 val) {
+  uint64_t limbs[4];
+  uint256_to_limbs(&val, limbs);
+  uint64_t h = hash_fold(limbs[0] ^ UINT64_C(0xa0761d6478bd642f), limbs[1] ^ UINT64_C(0xe7037ed1a0b428db)) ^
+               hash_fold(limbs[2] ^ UINT64_C(0x8ebc6af09c88c6e3), limbs[3] ^ UINT64_C(0x589965cc75374cc3));
+  return hash_fold(h ^ UINT64_C(0x1d8e4e27c47d124f), UINT64_C(0xe7037ed1a0b428db));
+}
+
+// Control byte values. A full slot stores the low 7 bits of its key's
+// hash, so the top bit marks slots with no key.
+#define MAP_EMPTY 0x80
+#define MAP_DELETED 0xFE
+#define MAP_GROUP 16
+
+// The largest capacity whose key array size still fits in a size_t.
+#define MAP_MAX_CAPACITY (SIZE_MAX / sizeof(UInt256))
+
+// Return a bit mask of the bytes in a 16-byte control group equal to
+// tag (bit i for byte i).
+static inline unsigned map_match(const uint8_t *group, uint8_t tag) {
+#ifdef __SSE2__
+  __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < MAP_GROUP; i++) {
+    mask |= (unsigned)(group[i] == tag) << i;
+  }
+  return mask;
+#endif
+}
+
+// Return a bit mask of the bytes in a control group that have no key
+// (empty or deleted).
+static inline unsigned map_match_free(const uint8_t *group) {
+#ifdef __SSE2__
+  return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+  unsigned mask = 0;
+  for (int i = 0; i < MAP_GROUP; i++) {
+    mask |= (unsigned)(group[i] >> 7) << i;
+  }
+  return mask;
+#endif
+}
+
+// Index of the lowest set bit of a nonzero mask.
+static inline int lowest_bit(unsigned mask) {
+#if defined(__GNUC__)
+  return __builtin_ctz(mask);
+#else
+  int i = 0;
+  while (!(mask & 1)) {
+    mask >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
+// Allocate empty storage with the given capacity (a power of two and a
+// multiple of MAP_GROUP). Returns 1 on success, or 0 if out of memory
+// or the capacity is too large (or has wrapped to 0), leaving map as
+// it was.
+static int map_alloc(UInt256Map *map, size_t capacity) {
+  if (capacity == 0 || capacity > MAP_MAX_CAPACITY) {
+    return 0;
+  }
+  map->ctrl = malloc(capacity);
+  map->keys = malloc(capacity * sizeof(UInt256));
+  map->values = malloc(capacity * sizeof(uint64_t));
+  if (map->ctrl == NULL || map->keys == NULL || map->values == NULL) {
+    free(map->ctrl);
+    free(map->keys);
+    free(map->values);
+    return 0;
+  }
+  memset(map->ctrl, MAP_EMPTY, capacity);
+  map->capacity = capacity;
+  map->size = 0;
+  map->growthLeft = capacity - capacity / 8;
+  return 1;
+}
+
+// Find the slot holding key, or return map->capacity if it's absent.
+// Groups are probed in triangular order, which visits every group, and
+// the search stops at the first group that still has an empty slot.
+static size_t map_find(const UInt256Map *map, const UInt256 *key, uint64_t hash) {
+  size_t groupMask = map->capacity / MAP_GROUP - 1;
+  size_t group = (size_t)(hash >> 7) & groupMask;
+  uint8_t tag = (uint8_t)(hash & 0x7F);
+  for (size_t step = 1;; step++) {
+    const uint8_t *ctrl = map->ctrl + group * MAP_GROUP;
+    for (unsigned match = map_match(ctrl, tag); match != 0; match &= match - 1) {
+      size_t slot = group * MAP_GROUP + (size_t)lowest_bit(match);
+      if (memcmp(&map->keys[slot], key, sizeof(UInt256)) == 0) {
+        return slot;
+      }
+    }
+    if (map_match(ctrl, MAP_EMPTY) != 0) {
+      return map->capacity;
+    }
+    group = (group + step) & groupMask;
+  }
+}
+
+// Find the first slot without a key along key's probe sequence.
+static size_t map_find_free(const UInt256Map *map, uint64_t hash) {
+  size_t groupMask = map->capacity / MAP_GROUP - 1;
+  size_t group = (size_t)(hash >> 7) & groupMask;
+  for (size_t step = 1;; step++) {
+    unsigned freeMask = map_match_free(map->ctrl + group * MAP_GROUP);
+    if (freeMask != 0) {
+      return group * MAP_GROUP + (size_t)lowest_bit(freeMask);
+    }
+    group = (group + step) & groupMask;
+  }
+}
+
+// Move every entry into fresh storage of the given capacity, which also
+// clears out deleted slots.
+static int map_rehash(UInt256Map *map, size_t capacity) {
+  UInt256Map old = *map;
+  if (!map_alloc(map, capacity)) {
+    *map = old;
+    return 0;
+  }
+  for (size_t i = 0; i < old.capacity; i++) {
+    if (!(old.ctrl[i] & 0x80)) {
+      uint64_t hash = uint256_hash(old.keys[i]);
+      size_t slot = map_find_free(map, hash);
+      map->ctrl[slot] = (uint8_t)(hash & 0x7F);
+      map->keys[slot] = old.keys[i];
+      map->values[slot] = old.values[i];
+    }
+  }
+  map->size = old.size;
+  map->growthLeft -= old.size;
+  uint256_map_destroy(&old);
+  return 1;
+}
+
+// Initialize an empty map sized for about expected entries.
+int uint256_map_init(UInt256Map *map, size_t expected) {
+  size_t capacity = MAP_GROUP;
+  while (capacity - capacity / 8 < expected) {
+    if (capacity > MAP_MAX_CAPACITY / 2) {
+      return 0;
+    }
+    capacity *= 2;
+  }
+  return map_alloc(map, capacity);
+}
+
+// Free the map's storage.
+void uint256_map_destroy(UInt256Map *map) {
+  free(map->ctrl);
+  free(map->keys);
+  free(map->values);
+  map->ctrl = NULL;
+  map->keys = NULL;
+  map->values = NULL;
+  map->capacity = 0;
+  map->size = 0;
+  map->growthLeft = 0;
+}
+
+// Insert or replace the value for key.
+int uint256_map_put(UInt256Map *map, UInt256 key, uint64_t value) {
+  uint64_t hash = uint256_hash(key);
+  size_t slot = map_find(map, &key, hash);
+  if (slot != map->capacity) {
+    map->values[slot] = value;
+    return 1;
+  }
+
+  slot = map_find_free(map, hash);
+  if (map->ctrl[slot] == MAP_EMPTY && map->growthLeft == 0) {
+    // Out of empty slots: grow, or just sweep out deleted slots if the
+    // table is mostly tombstones.
+    size_t capacity = map->size + 1 > map->capacity / 2 ? map->capacity * 2 : map->capacity;
+    if (!map_rehash(map, capacity)) {
+      return 0;
+    }
+    slot = map_find_free(map, hash);
+  }
+  if (map->ctrl[slot] == MAP_EMPTY) {
+    map->growthLeft--;
+  }
+  map->ctrl[slot] = (uint8_t)(hash & 0x7F);
+  map->keys[slot] = key;
+  map->values[slot] = value;
+  map->size++;
+  return 1;
+}
+
+// Look up key.
+int uint256_map_get(const UInt256Map *map, UInt256 key, uint64_t *value) {
+  size_t slot = map_find(map, &key, uint256_hash(key));
+  if (slot == map->capacity) {
+    return 0;
+  }
+  if (value != NULL) {
+    *value = map->values[slot];
+  }
+  return 1;
+}
+
+// Remove key. If its group still has an empty slot, no probe sequence
+// continues past the group, so the slot can go straight back to empty
+// instead of leaving a tombstone.
+int uint256_map_remove(UInt256Map *map, UInt256 key) {
+  size_t slot = map_find(map, &key, uint256_hash(key));
+  if (slot == map->capacity) {
+    return 0;
+  }
+  const uint8_t *group = map->ctrl + slot / MAP_GROUP * MAP_GROUP;
+  if (map_match(group, MAP_EMPTY) != 0) {
+    map->ctrl[slot] = MAP_EMPTY;
+    map->growthLeft++;
+  } else {
+    map->ctrl[slot] = MAP_DELETED;
+  }
+  map->size--;
+  return 1;
+}
+
+// Bitwise operations for the batch kernel.
+typedef enum { BIT_AND, BIT_OR, BIT_XOR, BIT_ANDNOT, BIT_NOT } BitOp;
+
+// Apply op element-wise over n values. The values are treated as one
+// flat run of 8 * n words, and the switch sits outside the loops, so
+// each case is a simple loop that vectorizes (a whole UInt256 per AVX2
+// register). For BIT_NOT, b is ignored.
+SOA_KERNEL void bitwise_kernel(UInt256 *out, const UInt256 *a, const UInt256 *b, size_t n, BitOp op) {
+  uint32_t *o = out->data;
+  const uint32_t *x = a->data;
+  const uint32_t *y = b->data;
+  size_t words = 8 * n;
+  switch (op) {
+  case BIT_AND:
+    for (size_t i = 0; i < words; i++) {
+      o[i] = x[i] & y[i];
+    }
+    break;
+  case BIT_OR:
+    for (size_t i = 0; i < words; i++) {
+      o[i] = x[i] | y[i];
+    }
+    break;
+  case BIT_XOR:
+    for (size_t i = 0; i < words; i++) {
+      o[i] = x[i] ^ y[i];
+    }
+    break;
+  case BIT_ANDNOT:
+    for (size_t i = 0; i < words; i++) {
+      o[i] = x[i] & ~y[i];
+    }
+    break;
+  case BIT_NOT:
+    for (size_t i = 0; i < words; i++) {
+      o[i] = ~x[i];
+    }
+    break;
+  }
+}
+
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+__attribute__((target("avx2")))
+static void bitwise_avx2(UInt256 *out, const UInt256 *a, const UInt256 *b, size_t n, BitOp op) {
+  bitwise_kernel(out, a, b, n, op);
+}
+#endif
+
+// Run the bitwise kernel, using AVX2 when the CPU supports it.
+static void bitwise_batch(UInt256 *out, const UInt256 *a, const UInt256 *b, size_t n, BitOp op) {
+  if (n == 0) {
+    return;
+  }
+#ifdef UINT256_HAVE_AVX2_DISPATCH
+  if (cpu_has_avx2()) {
+    bitwise_avx2(out, a, b, n, op);
+    return;
+  }
+#endif
+  bitwise_kernel(out, a, b, n, op);
+}
+
+// Store left[i] & right[i] in out[i] for each of the n elements.
+void uint256_and_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n) {
+  bitwise_batch(out, left, right, n, BIT_AND);
+}
+
+// Store left[i] | right[i] in out[i] for each of the n elements.
+void uint256_or_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n) {
+  bitwise_batch(out, left, right, n, BIT_OR);
+}
+
+// Store left[i] ^ right[i] in out[i] for each of the n elements.
+void uint256_xor_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n) {
+  bitwise_batch(out, left, right, n, BIT_XOR);
+}
+
+// Store left[i] & ~right[i] in out[i] for each of the n elements.
+void uint256_andnot_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n) {
+  bitwise_batch(out, left, right, n, BIT_ANDNOT);
+}
+
+// Store ~val[i] in out[i] for each of the n elements.
+void uint256_not_batch(UInt256 *out, const UInt256 *val, size_t n) {
+  bitwise_batch(out, val, val, n, BIT_NOT);
+}
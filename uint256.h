@@ -8,6 +8,7 @@
 #ifndef UINT256_H
 #define UINT256_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Data type representing a 256-bit unsigned integer, represented
@@ -21,6 +22,58 @@ typedef struct {
   uint32_t data[8];
 } UInt256;
 
+// Data type representing a 512-bit unsigned integer as two UInt256
+// halves. lo holds bits 0..255 and hi holds bits 256..511.
+typedef struct {
+  UInt256 lo;
+  UInt256 hi;
+} UInt512;
+
+// Structure-of-arrays layout for a set of UInt256 values: words[i][j]
+// holds word i (least significant first) of value j. The caller owns
+// the eight arrays, which must each hold at least as many elements as
+// are passed to the uint256_soa_* functions.
+typedef struct {
+  uint32_t *words[8];
+} UInt256SoA;
+
+// Precomputed context for Montgomery multiplication modulo a fixed odd
+// modulus. A value a in Montgomery form is stored as a * 2^256 mod mod,
+// which lets products be reduced without any division.
+typedef struct {
+  UInt256 mod;     // the modulus (must be odd)
+  UInt256 r2;      // 2^512 mod mod, used to convert into Montgomery form
+  uint64_t n0inv;  // -mod^-1 mod 2^64
+} UInt256MontCtx;
+
+// Precomputed powers of a fixed base for exponentiation modulo a fixed
+// odd modulus. table[i][d - 1] holds base^(d * 16^i) in Montgomery
+// form. The table is about 30KB, so avoid putting it on the stack.
+typedef struct {
+  UInt256MontCtx ctx;
+  UInt256 table[64][15];
+} UInt256FixedBase;
+
+// Result of parsing a UInt256 from text.
+typedef enum {
+  UINT256_PARSE_OK = 0,
+  UINT256_PARSE_EMPTY,          // no digits at all
+  UINT256_PARSE_INVALID_DIGIT,  // a character that isn't a valid digit
+  UINT256_PARSE_OVERFLOW,       // the value doesn't fit in 256 bits
+} UInt256ParseStatus;
+
+// Hash map from UInt256 keys to uint64_t values, using open addressing
+// with SIMD probing of 16-slot groups (Swiss table style). Treat the
+// fields as private; use the uint256_map_* functions.
+typedef struct {
+  uint8_t *ctrl;      // one control byte per slot: empty, deleted or a hash tag
+  UInt256 *keys;
+  uint64_t *values;
+  size_t capacity;    // number of slots, a power of two
+  size_t size;        // number of entries
+  size_t growthLeft;  // empty slots that may still be filled before growing
+} UInt256Map;
+
 // Create a UInt256 value from a single uint32_t value.
 // Only the least-significant 32 bits are initialized directly,
 // all other bits are set to 0.
@@ -31,13 +84,92 @@ UInt256 uint256_create_from_u32(uint32_t val);
 // at index 7 is the most significant.
 UInt256 uint256_create(const uint32_t data[8]);
 
-// Create a UInt256 value from a string of hexadecimal digits.
+// Create a UInt256 value from a string of hexadecimal digits. Input
+// that isn't valid hex is read 8 characters at a time from the right,
+// each chunk up to its first non-digit (as strtoul would); use
+// uint256_parse_hex to detect invalid input.
 UInt256 uint256_create_from_hex(const char *hex);
 
+// Parse exactly len characters of hex (which need not be
+// NUL-terminated), with an optional 0x or 0X prefix. If there are more
+// than 64 digits, only the last 64 are kept. *out is only written on
+// success.
+UInt256ParseStatus uint256_parse_hex(const char *hex, size_t len, UInt256 *out);
+
 // Return a dynamically-allocated string of hex digits representing the
 // given UInt256 value.
 char *uint256_format_as_hex(UInt256 val);
 
+// Buffer size that always fits uint256_format_hex_into's output: 64
+// digits plus the terminating NUL.
+#define UINT256_HEX_BUFSIZE 65
+
+// Write the hex digits of val, followed by a NUL, into buf (which holds
+// cap bytes) without allocating. Returns the number of digits written,
+// or 0 if buf is too small, in which case buf is left untouched.
+size_t uint256_format_hex_into(UInt256 val, char *buf, size_t cap);
+
+// Create a UInt256 value from a string of decimal digits. Invalid or
+// out-of-range input gives zero; use uint256_parse_dec to detect it.
+UInt256 uint256_create_from_dec(const char *dec);
+
+// Parse exactly len characters of decimal digits (which need not be
+// NUL-terminated). Values of 2^256 or more are reported as overflow
+// rather than truncated. *out is only written on success.
+UInt256ParseStatus uint256_parse_dec(const char *dec, size_t len, UInt256 *out);
+
+// Return a dynamically-allocated string of decimal digits representing
+// the given UInt256 value.
+char *uint256_format_as_dec(UInt256 val);
+
+// Buffer size that always fits uint256_format_dec_into's output: 78
+// digits for 2^256 - 1 plus the terminating NUL.
+#define UINT256_DEC_BUFSIZE 79
+
+// Write the decimal digits of val, followed by a NUL, into buf (which
+// holds cap bytes) without allocating. Returns the number of digits
+// written, or 0 if buf is too small, in which case buf is left
+// untouched.
+size_t uint256_format_dec_into(UInt256 val, char *buf, size_t cap);
+
+// Load a value from 32 bytes at p, most significant byte first (the
+// EVM word format) or least significant byte first. p need not be
+// aligned.
+UInt256 uint256_load_be(const uint8_t *p);
+UInt256 uint256_load_le(const uint8_t *p);
+
+// Store a value as 32 bytes at p, most or least significant byte
+// first. p need not be aligned.
+void uint256_store_be(UInt256 val, uint8_t *p);
+void uint256_store_le(UInt256 val, uint8_t *p);
+
+// Load or store n packed 32-byte records (32 * n bytes at p), e.g.
+// straight out of a memory-mapped file.
+void uint256_load_be_batch(UInt256 *out, const uint8_t *p, size_t n);
+void uint256_load_le_batch(UInt256 *out, const uint8_t *p, size_t n);
+void uint256_store_be_batch(uint8_t *p, const UInt256 *vals, size_t n);
+void uint256_store_le_batch(uint8_t *p, const UInt256 *vals, size_t n);
+
+// Largest encoded size of a varint: a count byte and 32 value bytes.
+#define UINT256_VARINT_MAX 33
+
+// Encode val compactly into buf (which holds cap bytes): one byte
+// giving the number of significant bytes (0 to 32), then those bytes
+// least significant first. Zero encodes as the single byte 0. Returns
+// the encoded size, or 0 if buf is too small.
+size_t uint256_encode_varint(UInt256 val, uint8_t *buf, size_t cap);
+
+// Decode a varint from the first avail bytes of buf. Returns the number
+// of bytes consumed, or 0 if the input is truncated, the count exceeds
+// 32, or the encoding isn't minimal (its top byte is zero). *out is
+// only written on success.
+size_t uint256_decode_varint(const uint8_t *buf, size_t avail, UInt256 *out);
+
+// Decode n consecutive varints from the first avail bytes of buf.
+// Returns the total number of bytes consumed, or 0 if any of them is
+// malformed (values before the bad one are still stored).
+size_t uint256_decode_varint_batch(UInt256 *out, size_t n, const uint8_t *buf, size_t avail);
+
 // Get 32 bits of data from a UInt256 value.
 // Index 0 is the least significant 32 bits, index 7 is the most
 // significant 32 bits.
@@ -51,12 +183,80 @@ UInt256 uint256_sub(UInt256 left, UInt256 right);
 
 // Return the two's-complement negation of the given UInt256 value.
 UInt256 uint256_negate(UInt256 val);
-#if 0
 
-// Not assigning this for Fall 2023
-// Compute the product of two UInt256 values.
+// Compute the product of two UInt256 values. Only the least-significant
+// 256 bits of the product are returned.
 UInt256 uint256_mul(UInt256 left, UInt256 right);
-#endif
+
+// Compute the full 512-bit product of two UInt256 values.
+UInt512 uint256_mul_wide(UInt256 left, UInt256 right);
+
+// Compute left + right + carryIn (carryIn must be 0 or 1). The carry
+// out of the most significant bit is stored in *carryOut unless it
+// is NULL, so wider integers can be built by chaining calls.
+UInt256 uint256_add_carry(UInt256 left, UInt256 right, unsigned carryIn, unsigned *carryOut);
+
+// Compute left - right - borrowIn (borrowIn must be 0 or 1). The
+// borrow out of the most significant bit is stored in *borrowOut
+// unless it is NULL.
+UInt256 uint256_sub_borrow(UInt256 left, UInt256 right, unsigned borrowIn, unsigned *borrowOut);
+
+// Compute the sum of two UInt512 values (modulo 2^512).
+UInt512 uint512_add(UInt512 left, UInt512 right);
+
+// Compute the difference of two UInt512 values (modulo 2^512).
+UInt512 uint512_sub(UInt512 left, UInt512 right);
+
+// Pointer-based variants of the operations above. Each stores its
+// result in *dst and reads its operands through const pointers, which
+// avoids copying 32-byte values in and out of every call. dst may
+// alias any operand, so in-place updates like
+// uint256_add_to(&acc, &acc, &x) are fine.
+void uint256_add_to(UInt256 *dst, const UInt256 *left, const UInt256 *right);
+void uint256_sub_to(UInt256 *dst, const UInt256 *left, const UInt256 *right);
+void uint256_negate_to(UInt256 *dst, const UInt256 *val);
+void uint256_mul_to(UInt256 *dst, const UInt256 *left, const UInt256 *right);
+void uint256_rotate_left_to(UInt256 *dst, const UInt256 *val, unsigned nbits);
+void uint256_rotate_right_to(UInt256 *dst, const UInt256 *val, unsigned nbits);
+
+// Compare two UInt256 values, returning -1, 0 or 1 as left is less
+// than, equal to or greater than right.
+int uint256_cmp(UInt256 left, UInt256 right);
+
+// Return 1 if left equals right, 0 otherwise.
+int uint256_eq(UInt256 left, UInt256 right);
+
+// Return 1 if left is less than right, 0 otherwise.
+int uint256_lt(UInt256 left, UInt256 right);
+
+// Like uint256_cmp, but runs in time independent of the values, for
+// comparing secrets.
+int uint256_ct_cmp(UInt256 left, UInt256 right);
+
+// Constant-time operations for secret data: each runs the same
+// instructions and touches the same memory whatever its operands are.
+UInt256 uint256_ct_add(UInt256 left, UInt256 right);
+UInt256 uint256_ct_sub(UInt256 left, UInt256 right);
+UInt256 uint256_ct_negate(UInt256 val);
+UInt256 uint256_ct_rotate_left(UInt256 val, unsigned nbits);
+UInt256 uint256_ct_rotate_right(UInt256 val, unsigned nbits);
+
+// Return a if cond is nonzero, b otherwise, in constant time.
+UInt256 uint256_ct_select(unsigned cond, UInt256 a, UInt256 b);
+
+// Swap *a and *b if cond is nonzero, in constant time.
+void uint256_ct_cswap(unsigned cond, UInt256 *a, UInt256 *b);
+
+// Divide num by den, storing the quotient in *quot and the remainder
+// in *rem. Either pointer may be NULL if that result isn't needed.
+// Division by zero stores zero in both results.
+void uint256_divmod(UInt256 num, UInt256 den, UInt256 *quot, UInt256 *rem);
+
+// Compute the quotient of two UInt256 values (zero if right is zero).
+UInt256 uint256_div(UInt256 left, UInt256 right);
+
+// Compute the remainder of two UInt256 values (zero if right is zero).
+UInt256 uint256_mod(UInt256 left, UInt256 right);
 
 // Return the result of rotating every bit in val nbits to
 // the left.  Any bits shifted past the most significant bit
@@ -68,6 +268,214 @@ UInt256 uint256_rotate_left(UInt256 val, unsigned nbits);
 // should be shifted back into the most significant bits.
 UInt256 uint256_rotate_right(UInt256 val, unsigned nbits);
 
+// Return val shifted left by nbits. Bits shifted past the most
+// significant bit are discarded; shifting by 256 or more gives 0.
+// Like the rotates, shifts run in time independent of nbits.
+UInt256 uint256_shl(UInt256 val, unsigned nbits);
+
+// Return val shifted right by nbits (a logical shift). Shifting by
+// 256 or more gives 0.
+UInt256 uint256_shr(UInt256 val, unsigned nbits);
+
+// Bitwise operations. uint256_andnot returns left & ~right, i.e. left
+// with the bits set in right cleared.
+UInt256 uint256_and(UInt256 left, UInt256 right);
+UInt256 uint256_or(UInt256 left, UInt256 right);
+UInt256 uint256_xor(UInt256 left, UInt256 right);
+UInt256 uint256_andnot(UInt256 left, UInt256 right);
+UInt256 uint256_not(UInt256 val);
+
+// Count the leading (most significant) zero bits of val. Zero gives
+// 256.
+unsigned uint256_clz(UInt256 val);
+
+// Count the trailing (least significant) zero bits of val. Zero gives
+// 256.
+unsigned uint256_ctz(UInt256 val);
+
+// Count the bits of val that are set.
+unsigned uint256_popcount(UInt256 val);
+
+// Return the number of bits needed to represent val (0 for zero, 256
+// when the top bit is set).
+unsigned uint256_bit_length(UInt256 val);
+
+// Return bit index of val (0 or 1). Indexes of 256 or more give 0.
+int uint256_test_bit(UInt256 val, unsigned index);
+
+// Return width bits of val starting at bit lo, as the low bits of the
+// result. Bits past the top of val read as zero. A width of 0 gives 0,
+// and widths above 64 are treated as 64.
+uint64_t uint256_extract_bits(UInt256 val, unsigned lo, unsigned width);
+
+// Initialize a Montgomery context for the given modulus. Returns 1 on
+// success, or 0 if the modulus is even (Montgomery reduction needs an
+// odd modulus).
+int uint256_mont_init(UInt256MontCtx *ctx, UInt256 mod);
+
+// Convert a value into Montgomery form (val * 2^256 mod modulus).
+UInt256 uint256_to_mont(const UInt256MontCtx *ctx, UInt256 val);
+
+// Convert a value out of Montgomery form (val * 2^-256 mod modulus).
+UInt256 uint256_from_mont(const UInt256MontCtx *ctx, UInt256 val);
+
+// Multiply two values in Montgomery form. Both operands must be less
+// than the modulus; the result is in Montgomery form.
+UInt256 uint256_mont_mul(const UInt256MontCtx *ctx, UInt256 left, UInt256 right);
+
+// Square a value in Montgomery form. The operand must be less than the
+// modulus; the result is in Montgomery form.
+UInt256 uint256_mont_sqr(const UInt256MontCtx *ctx, UInt256 val);
+
+// Compute (left * right) mod mod using the full 512-bit product.
+// Returns zero if mod is zero.
+UInt256 uint256_mulmod(UInt256 left, UInt256 right, UInt256 mod);
+
+// Compute (base ^ exp) mod mod using a sliding-window scan of the
+// exponent. Odd moduli use Montgomery multiplication. Returns zero if
+// mod is zero.
+UInt256 uint256_modexp(UInt256 base, UInt256 exp, UInt256 mod);
+
+// Precompute the table for a fixed base and odd modulus. Returns 1 on
+// success, or 0 if the modulus is even.
+int uint256_fixed_base_init(UInt256FixedBase *fb, UInt256 base, UInt256 mod);
+
+// Compute (base ^ exp) mod mod for the base and modulus that fb was
+// initialized with, using table lookups and no squarings.
+UInt256 uint256_fixed_base_exp(const UInt256FixedBase *fb, UInt256 exp);
+
+// Field arithmetic modulo the secp256k1 prime p = 2^256 - 2^32 - 977.
+// All operands must already be reduced (less than p).
+UInt256 uint256_fp_k1_add(UInt256 left, UInt256 right);
+UInt256 uint256_fp_k1_sub(UInt256 left, UInt256 right);
+UInt256 uint256_fp_k1_mul(UInt256 left, UInt256 right);
+UInt256 uint256_fp_k1_sqr(UInt256 val);
+// Return the inverse of val mod p (zero maps to zero).
+UInt256 uint256_fp_k1_inv(UInt256 val);
+
+// Field arithmetic modulo the NIST P-256 prime
+// p = 2^256 - 2^224 + 2^192 + 2^96 - 1.
+// All operands must already be reduced (less than p).
+UInt256 uint256_fp_p256_add(UInt256 left, UInt256 right);
+UInt256 uint256_fp_p256_sub(UInt256 left, UInt256 right);
+UInt256 uint256_fp_p256_mul(UInt256 left, UInt256 right);
+UInt256 uint256_fp_p256_sqr(UInt256 val);
+// Return the inverse of val mod p (zero maps to zero).
+UInt256 uint256_fp_p256_inv(UInt256 val);
+
+// Return the greatest common divisor of left and right. gcd(0, x) is x.
+UInt256 uint256_gcd(UInt256 left, UInt256 right);
+
+// Return val^-1 mod mod, or zero if no inverse exists (val and mod
+// aren't coprime) or mod is zero. Runs in variable time.
+UInt256 uint256_modinv(UInt256 val, UInt256 mod);
+
+// Constant-time val^-1 mod mod for an odd modulus. val must be less
+// than mod. Returns zero if no inverse exists or mod is even.
+UInt256 uint256_ct_modinv(UInt256 val, UInt256 mod);
+
+// Store vals[i]^-1 mod mod in out[i] for each of the n values, using a
+// single inversion. out must not overlap vals. Returns 1 on success, or
+// 0 (with every output zero) if any value has no inverse.
+int uint256_modinv_batch(UInt256 *out, const UInt256 *vals, size_t n, UInt256 mod);
+
+// Return floor(sqrt(val)).
+UInt256 uint256_isqrt(UInt256 val);
+
+// Return 1 if val is a perfect square, storing its square root in *root
+// (which may be NULL), or 0 otherwise.
+int uint256_is_square(UInt256 val, UInt256 *root);
+
+// Element-wise operations over arrays of n values. out may be the same
+// array as an input.
+void uint256_add_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n);
+void uint256_sub_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n);
+void uint256_negate_batch(UInt256 *out, const UInt256 *val, size_t n);
+
+// Copy n values into or out of structure-of-arrays layout.
+void uint256_soa_load(const UInt256SoA *dst, const UInt256 *src, size_t n);
+void uint256_soa_store(UInt256 *dst, const UInt256SoA *src, size_t n);
+
+// Element-wise operations over n values in structure-of-arrays layout.
+// Carries propagate across the word arrays for many values at once,
+// using AVX2 when the CPU supports it. out may be the same as an input.
+void uint256_soa_add(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n);
+void uint256_soa_sub(const UInt256SoA *out, const UInt256SoA *a, const UInt256SoA *b, size_t n);
+void uint256_soa_negate(const UInt256SoA *out, const UInt256SoA *a, size_t n);
+
+// Parse n fixed-width records from text, each exactly 64 hex digits
+// with no prefix or separator (so text holds 64 * n characters).
+// Returns n on success, or the index of the first record containing a
+// character that isn't a hex digit; records before it are stored.
+size_t uint256_parse_hex_batch(UInt256 *out, const char *text, size_t n);
+
+// Format n values into text as fixed-width records of 64 lowercase hex
+// digits with leading zeros. Writes exactly 64 * n characters and no
+// NUL.
+void uint256_format_hex_batch(char *text, const UInt256 *vals, size_t n);
+
+// Return the index of the largest or smallest of the n values. Ties go
+// to the lowest index. With n == 0 there is no such value, and the
+// result is n (0) without reading vals.
+size_t uint256_max_index(const UInt256 *vals, size_t n);
+size_t uint256_min_index(const UInt256 *vals, size_t n);
+
+// Sort n values in ascending order, in place, using an MSD radix sort
+// over the bytes of the values.
+void uint256_sort(UInt256 *vals, size_t n);
+
+// Like uint256_sort, but splits the work across up to numThreads
+// threads (including the calling thread). Returns the number of
+// independent buckets the values were split into for the threads to
+// share (1 when the sort ran on the calling thread alone).
+unsigned uint256_sort_parallel(UInt256 *vals, size_t n, unsigned numThreads);
+
+// Return the index of the first of the n values in sorted (ascending
+// order) that is not less than key, or n if there is none.
+size_t uint256_lower_bound(const UInt256 *sorted, size_t n, UInt256 key);
+
+// Copy n values from sorted (ascending order) into tree in Eytzinger
+// (breadth-first) layout, where the children of tree[i] are
+// tree[2 * i + 1] and tree[2 * i + 2]. Searching this layout touches
+// memory in a predictable order that caches and prefetches well.
+void uint256_eytzinger_build(UInt256 *tree, const UInt256 *sorted, size_t n);
+
+// Return the index in tree (built by uint256_eytzinger_build) of the
+// smallest value that is not less than key, or n if there is none.
+size_t uint256_eytzinger_lower_bound(const UInt256 *tree, size_t n, UInt256 key);
+
+// Return a 64-bit hash of val, suitable for hash tables.
+uint64_t uint256_hash(UInt256 val);
+
+// Initialize an empty map with room for about expected entries before
+// it has to grow. Returns 1 on success, or 0 if out of memory or
+// expected is too large for the table's arrays to be addressed.
+int uint256_map_init(UInt256Map *map, size_t expected);
+
+// Free the storage of a map. It must be initialized again before reuse.
+void uint256_map_destroy(UInt256Map *map);
+
+// Set the value for key, replacing any existing one. The map grows when
+// it is 7/8 full. Returns 1 on success, or 0 if out of memory (the map
+// is left unchanged).
+int uint256_map_put(UInt256Map *map, UInt256 key, uint64_t value);
+
+// Look up key, storing its value in *value (unless value is NULL).
+// Returns 1 if key is present, 0 otherwise.
+int uint256_map_get(const UInt256Map *map, UInt256 key, uint64_t *value);
+
+// Remove key. Returns 1 if it was present, 0 otherwise.
+int uint256_map_remove(UInt256Map *map, UInt256 key);
+
+// Element-wise bitwise operations over arrays of n values, vectorized
+// (with AVX2 when the CPU supports it). out may be the same array as an
+// input.
+void uint256_and_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n);
+void uint256_or_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n);
+void uint256_xor_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n);
+void uint256_andnot_batch(UInt256 *out, const UInt256 *left, const UInt256 *right, size_t n);
+void uint256_not_batch(UInt256 *out, const UInt256 *val, size_t n);
+
 // You may add additional functions if you would like to
 
 #endif // UINT256_H
@@ -0,0 +1,195 @@
+/*
+ * EVM-compatible 256-bit arithmetic built on the UInt256 library
+ * CSF Assignment 1 - Milestone 1
+ * Yoohyuk Chang  * ychang82@jhu.edu
+ * Yongjae Lee  * ylee207@jhu.edu
+ */
+
+#include "uint256_evm.h"
+
+// Return 1 if val fits in 64 bits.
+static int fits_u64(const UInt256 *val) {
+  for (int i = 2; i < 8; i++) {
+    if (val->data[i] != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static uint64_t to_u64(const UInt256 *val) {
+  return (uint64_t)val->data[0] | ((uint64_t)val->data[1] << 32);
+}
+
+static UInt256 from_u64(uint64_t val) {
+  UInt256 result = {0};
+  result.data[0] = (uint32_t)val;
+  result.data[1] = (uint32_t)(val >> 32);
+  return result;
+}
+
+// Return 1 if val is negative as a two's complement value.
+static int is_negative(const UInt256 *val) {
+  return (int)(val->data[7] >> 31);
+}
+
+// Return the absolute value of a two's complement value. -2^255 maps
+// to itself, which read as unsigned is the right magnitude.
+static UInt256 abs_value(UInt256 val) {
+  return is_negative(&val) ? uint256_negate(val) : val;
+}
+
+// Clamp a shift or index operand to an unsigned no greater than limit.
+static unsigned clamp_operand(const UInt256 *val, unsigned limit) {
+  if (!fits_u64(val) || to_u64(val) > limit) {
+    return limit;
+  }
+  return (unsigned)to_u64(val);
+}
+
+static UInt256 from_bool(int cond) {
+  return uint256_create_from_u32(cond ? 1U : 0U);
+}
+
+// Compute a / b. Operands that fit in 64 bits, which are common in
+// EVM code, use a native division.
+UInt256 uint256_evm_div(UInt256 a, UInt256 b) {
+  if (fits_u64(&a) && fits_u64(&b)) {
+    uint64_t d = to_u64(&b);
+    return from_u64(d == 0 ? 0 : to_u64(&a) / d);
+  }
+  return uint256_div(a, b);
+}
+
+// Compute a mod b, with the same 64-bit fast path as uint256_evm_div.
+UInt256 uint256_evm_mod(UInt256 a, UInt256 b) {
+  if (fits_u64(&a) && fits_u64(&b)) {
+    uint64_t d = to_u64(&b);
+    return from_u64(d == 0 ? 0 : to_u64(&a) % d);
+  }
+  return uint256_mod(a, b);
+}
+
+// Divide the magnitudes and negate the quotient if exactly one operand
+// is negative.
+UInt256 uint256_evm_sdiv(UInt256 a, UInt256 b) {
+  UInt256 quot = uint256_evm_div(abs_value(a), abs_value(b));
+  return is_negative(&a) != is_negative(&b) ? uint256_negate(quot) : quot;
+}
+
+// Reduce the magnitudes and give the remainder the sign of a.
+UInt256 uint256_evm_smod(UInt256 a, UInt256 b) {
+  UInt256 rem = uint256_evm_mod(abs_value(a), abs_value(b));
+  return is_negative(&a) ? uint256_negate(rem) : rem;
+}
+
+// Reduce both operands first; their sum is then below 2n, so one
+// conditional subtraction finishes the job. When the sum carries out
+// of 256 bits, the wrapped subtraction still gives the right value.
+UInt256 uint256_evm_addmod(UInt256 a, UInt256 b, UInt256 n) {
+  if (uint256_bit_length(n) == 0) {
+    return n;
+  }
+  unsigned carry;
+  UInt256 sum = uint256_add_carry(uint256_evm_mod(a, n), uint256_evm_mod(b, n), 0, &carry);
+  if (carry || !uint256_lt(sum, n)) {
+    sum = uint256_sub(sum, n);
+  }
+  return sum;
+}
+
+// If the product fits in 256 bits, a single multiply and reduction do;
+// otherwise reduce the full 512-bit product.
+UInt256 uint256_evm_mulmod(UInt256 a, UInt256 b, UInt256 n) {
+  if (uint256_bit_length(a) + uint256_bit_length(b) <= 256) {
+    return uint256_evm_mod(uint256_mul(a, b), n);
+  }
+  return uint256_mulmod(a, b, n);
+}
+
+// Square-and-multiply mod 2^256 (plain wrapping multiplication). Small
+// bases and powers of two are answered directly, and any even base
+// raised to 256 or more is zero, since the result has at least b
+// factors of two.
+UInt256 uint256_evm_exp(UInt256 a, UInt256 b) {
+  UInt256 one = uint256_create_from_u32(1U);
+  unsigned len = uint256_bit_length(b);
+  if (len == 0) {
+    return one;
+  }
+  if (uint256_bit_length(a) <= 1) {
+    return a;
+  }
+  if ((a.data[0] & 1) == 0 && len > 8) {
+    return uint256_create_from_u32(0U);
+  }
+  if (uint256_popcount(a) == 1) {
+    // (2^k)^b = 2^(k * b), with b < 256 here
+    return uint256_shl(one, uint256_ctz(a) * clamp_operand(&b, 256));
+  }
+
+  UInt256 result = a;
+  for (int i = (int)len - 2; i >= 0; i--) {
+    result = uint256_mul(result, result);
+    if (uint256_test_bit(b, (unsigned)i)) {
+      result = uint256_mul(result, a);
+    }
+  }
+  return result;
+}
+
+// Copy bit 8 * b + 7 of x into every bit above it.
+UInt256 uint256_evm_signextend(UInt256 b, UInt256 x) {
+  unsigned byteIndex = clamp_operand(&b, 31);
+  if (byteIndex == 31) {
+    return x;
+  }
+  unsigned bit = 8 * byteIndex + 7;
+  UInt256 high = uint256_shl(uint256_not(uint256_create_from_u32(0U)), bit + 1);
+  return uint256_test_bit(x, bit) ? uint256_or(x, high) : uint256_andnot(x, high);
+}
+
+// Pick one byte, counting from the most significant end.
+UInt256 uint256_evm_byte(UInt256 i, UInt256 x) {
+  unsigned index = clamp_operand(&i, 32);
+  if (index == 32) {
+    return uint256_create_from_u32(0U);
+  }
+  unsigned bit = 8 * (31 - index);
+  return uint256_create_from_u32((x.data[bit / 32] >> (bit % 32)) & 0xFFU);
+}
+
+// Shift val left by shift bits; a shift of 256 or more gives 0.
+UInt256 uint256_evm_shl(UInt256 shift, UInt256 val) {
+  return uint256_shl(val, clamp_operand(&shift, 256));
+}
+
+// Shift val right by shift bits, bringing in zeros; a shift of 256 or
+// more gives 0.
+UInt256 uint256_evm_shr(UInt256 shift, UInt256 val) {
+  return uint256_shr(val, clamp_operand(&shift, 256));
+}
+
+// Arithmetic shift right: a negative value is complemented, shifted
+// logically (bringing in zeros) and complemented back, so ones come in
+// from the top.
+UInt256 uint256_evm_sar(UInt256 shift, UInt256 val) {
+  unsigned nbits = clamp_operand(&shift, 256);
+  if (is_negative(&val)) {
+    return uint256_not(uint256_shr(uint256_not(val), nbits));
+  }
+  return uint256_shr(val, nbits);
+}
+
+// Signed comparison: flipping the sign bits maps two's complement
+// order onto unsigned order.
+UInt256 uint256_evm_slt(UInt256 a, UInt256 b) {
+  a.data[7] ^= 0x80000000U;
+  b.data[7] ^= 0x80000000U;
+  return from_bool(uint256_lt(a, b));
+}
+
+// Signed a > b, comparing both as two's complement values.
+UInt256 uint256_evm_sgt(UInt256 a, UInt256 b) {
+  return uint256_evm_slt(b, a);
+}
@@ -0,0 +1,58 @@
+/*
+ * EVM-compatible 256-bit arithmetic built on the UInt256 library
+ * CSF Assignment 1 - Milestone 1
+ * Yoohyuk Chang  * ychang82@jhu.edu
+ * Yongjae Lee  * ylee207@jhu.edu
+ */
+
+#ifndef UINT256_EVM_H
+#define UINT256_EVM_H
+
+#include "uint256.h"
+
+// Each function implements the Ethereum Virtual Machine opcode of the
+// same name. Operands and results are UInt256 words; the signed
+// opcodes read them as two's complement, consistent with
+// uint256_negate. As on the EVM, division or reduction by zero gives
+// zero, and comparisons give 1 or 0.
+
+// DIV and MOD: unsigned quotient and remainder.
+UInt256 uint256_evm_div(UInt256 a, UInt256 b);
+UInt256 uint256_evm_mod(UInt256 a, UInt256 b);
+
+// SDIV: signed quotient, rounded toward zero. -2^255 / -1 overflows
+// back to -2^255.
+UInt256 uint256_evm_sdiv(UInt256 a, UInt256 b);
+
+// SMOD: signed remainder, with the sign of a.
+UInt256 uint256_evm_smod(UInt256 a, UInt256 b);
+
+// ADDMOD and MULMOD: (a + b) mod n and (a * b) mod n, computed without
+// losing the carry or the high half of the product.
+UInt256 uint256_evm_addmod(UInt256 a, UInt256 b, UInt256 n);
+UInt256 uint256_evm_mulmod(UInt256 a, UInt256 b, UInt256 n);
+
+// EXP: a ^ b mod 2^256.
+UInt256 uint256_evm_exp(UInt256 a, UInt256 b);
+
+// SIGNEXTEND: extend the sign bit of byte b (counting from the least
+// significant byte) of x through the upper bytes. b of 31 or more
+// leaves x unchanged.
+UInt256 uint256_evm_signextend(UInt256 b, UInt256 x);
+
+// BYTE: byte i of x counting from the most significant byte, or zero
+// if i is 32 or more.
+UInt256 uint256_evm_byte(UInt256 i, UInt256 x);
+
+// SHL, SHR and SAR: shift val by shift bits (note the EVM's operand
+// order). Shifting by 256 or more gives zero, or all ones for SAR of a
+// negative value.
+UInt256 uint256_evm_shl(UInt256 shift, UInt256 val);
+UInt256 uint256_evm_shr(UInt256 shift, UInt256 val);
+UInt256 uint256_evm_sar(UInt256 shift, UInt256 val);
+
+// SLT and SGT: signed a < b and a > b.
+UInt256 uint256_evm_slt(UInt256 a, UInt256 b);
+UInt256 uint256_evm_sgt(UInt256 a, UInt256 b);
+
+#endif // UINT256_EVM_H
@@ -1,8 +1,12 @@
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "tctest.h"
 
 #include "uint256.h"
+#include "uint256_evm.h"
 
 typedef struct {
   UInt256 zero; // the value equal to 0
@@ -14,6 +18,7 @@ typedef struct {
 
 // Helper functions for implementing tests
 void set_all(UInt256 *val, uint32_t wordval);
+double ct_timing_t(int op);
 
 #define ASSERT_SAME(expected, actual) \
 do { \
@@ -95,6 +100,111 @@ void test_uint256_format_as_hex_trailing_zeros();
 void test_uint256_create_from_hex_larger_than_256();
 void test_uint256_create_from_hex_small_number();
 void test_uint256_create_from_hex_not_multiple_or_8();
+void test_uint256_create_from_hex_invalid_digits();
+
+void test_mul_small_values();
+void test_mul_overflow_truncates();
+void test_mul_random();
+void test_mul_wide_max();
+void test_mul_wide_random();
+
+void test_divmod_by_32_bit_value();
+void test_divmod_by_64_bit_value();
+void test_divmod_general();
+void test_divmod_add_back();
+void test_divmod_smaller_numerator();
+void test_divmod_by_zero();
+
+void test_mont_init_rejects_even_modulus();
+void test_mont_init_precomputes_r2();
+void test_mont_round_trip();
+void test_mont_mul();
+void test_mont_sqr();
+
+void test_mulmod();
+void test_modexp_small_values();
+void test_modexp_odd_modulus();
+void test_modexp_even_modulus();
+void test_modexp_fermat();
+void test_fixed_base_exp();
+
+void test_fp_k1_add_sub();
+void test_fp_k1_mul_sqr();
+void test_fp_k1_inv();
+void test_fp_p256_add_sub();
+void test_fp_p256_mul_sqr();
+void test_fp_p256_inv();
+
+void test_add_to_in_place();
+void test_sub_to_borrow();
+void test_negate_to_in_place();
+void test_mul_to_in_place();
+void test_rotate_to_in_place();
+
+void test_add_carry_chain_across_limbs();
+void test_sub_borrow_chain_across_limbs();
+
+void test_add_carry_in_and_out();
+void test_sub_borrow_in_and_out();
+void test_uint512_add();
+void test_uint512_sub();
+
+void test_shl();
+void test_shr();
+void test_shift_by_256_or_more();
+void test_rotate_by_limb_multiples();
+
+void test_batch_add_sub_negate();
+void test_soa_add_sub_negate();
+
+void test_format_hex_into();
+
+void test_parse_hex();
+void test_parse_hex_errors();
+
+void test_hex_batch_round_trip();
+void test_parse_hex_batch_invalid();
+
+void test_format_dec();
+void test_parse_dec();
+
+void test_load_store_bytes();
+void test_load_store_batch();
+
+void test_varint_round_trip();
+void test_varint_errors();
+
+void test_cmp_eq_lt();
+void test_min_max_index();
+void test_min_max_index_equal_top_words();
+
+void test_sort();
+void test_sort_parallel_shared_top_bytes();
+void test_lower_bound_and_eytzinger();
+
+void test_hash();
+void test_map_put_get_remove();
+
+void test_bitwise();
+void test_bitwise_batch();
+
+void test_bit_counts();
+void test_test_and_extract_bits();
+void test_divmod_power_of_two();
+void test_ct_select_cswap();
+void test_ct_arithmetic();
+void test_ct_timing();
+
+void test_gcd();
+void test_modinv();
+void test_modinv_batch();
+void test_isqrt();
+void test_is_square();
+
+void test_evm_arithmetic();
+void test_evm_signed_arithmetic();
+void test_evm_bytes_and_shifts();
+void test_evm_signed_compare();
 
 int main(int argc, char **argv) {
   if (argc > 1) {
@@ -160,6 +270,117 @@ int main(int argc, char **argv) {
   // TEST(test_uint256_create_from_hex_larger_than_256);
   TEST(test_uint256_create_from_hex_small_number);
   TEST(test_uint256_create_from_hex_not_multiple_or_8);
+  TEST(test_uint256_create_from_hex_invalid_digits);
+
+  TEST(test_mul_small_values);
+  TEST(test_mul_overflow_truncates);
+  TEST(test_mul_random);
+  TEST(test_mul_wide_max);
+  TEST(test_mul_wide_random);
+
+  TEST(test_divmod_by_32_bit_value);
+  TEST(test_divmod_by_64_bit_value);
+  TEST(test_divmod_general);
+  TEST(test_divmod_add_back);
+  TEST(test_divmod_smaller_numerator);
+  TEST(test_divmod_by_zero);
+
+  TEST(test_mont_init_rejects_even_modulus);
+  TEST(test_mont_init_precomputes_r2);
+  TEST(test_mont_round_trip);
+  TEST(test_mont_mul);
+  TEST(test_mont_sqr);
+
+  TEST(test_mulmod);
+  TEST(test_modexp_small_values);
+  TEST(test_modexp_odd_modulus);
+  TEST(test_modexp_even_modulus);
+  TEST(test_modexp_fermat);
+  TEST(test_fixed_base_exp);
+
+  TEST(test_fp_k1_add_sub);
+  TEST(test_fp_k1_mul_sqr);
+  TEST(test_fp_k1_inv);
+  TEST(test_fp_p256_add_sub);
+  TEST(test_fp_p256_mul_sqr);
+  TEST(test_fp_p256_inv);
+
+  TEST(test_add_to_in_place);
+  TEST(test_sub_to_borrow);
+  TEST(test_negate_to_in_place);
+  TEST(test_mul_to_in_place);
+  TEST(test_rotate_to_in_place);
+
+  TEST(test_add_carry_chain_across_limbs);
+  TEST(test_sub_borrow_chain_across_limbs);
+
+  TEST(test_add_carry_in_and_out);
+  TEST(test_sub_borrow_in_and_out);
+  TEST(test_uint512_add);
+  TEST(test_uint512_sub);
+
+  TEST(test_shl);
+  TEST(test_shr);
+  TEST(test_shift_by_256_or_more);
+  TEST(test_rotate_by_limb_multiples);
+
+  TEST(test_batch_add_sub_negate);
+  TEST(test_soa_add_sub_negate);
+
+  TEST(test_format_hex_into);
+
+  TEST(test_parse_hex);
+  TEST(test_parse_hex_errors);
+
+  TEST(test_hex_batch_round_trip);
+  TEST(test_parse_hex_batch_invalid);
+
+  TEST(test_format_dec);
+  TEST(test_parse_dec);
+
+  TEST(test_load_store_bytes);
+  TEST(test_load_store_batch);
+
+  TEST(test_varint_round_trip);
+  TEST(test_varint_errors);
+
+  TEST(test_cmp_eq_lt);
+  TEST(test_min_max_index);
+  TEST(test_min_max_index_equal_top_words);
+
+  TEST(test_sort);
+  TEST(test_sort_parallel_shared_top_bytes);
+  TEST(test_lower_bound_and_eytzinger);
+
+  TEST(test_hash);
+  TEST(test_map_put_get_remove);
+
+  TEST(test_bitwise);
+  TEST(test_bitwise_batch);
+
+  TEST(test_bit_counts);
+  TEST(test_test_and_extract_bits);
+  TEST(test_divmod_power_of_two);
+
+  TEST(test_ct_select_cswap);
+  TEST(test_ct_arithmetic);
+
+  TEST(test_gcd);
+  TEST(test_modinv);
+  TEST(test_modinv_batch);
+  TEST(test_isqrt);
+  TEST(test_is_square);
+
+  TEST(test_evm_arithmetic);
+  TEST(test_evm_signed_arithmetic);
+  TEST(test_evm_bytes_and_shifts);
+  TEST(test_evm_signed_compare);
+
+  // Timing is slow and sensitive to machine noise, so this only runs
+  // when asked for by name: ./uint256_tests test_ct_timing
+  if (tctest_testname_to_execute) {
+    TEST(test_ct_timing);
+  }
   TEST_FINI();
 }
 
@@ -170,6 +391,97 @@ void set_all(UInt256 *val, uint32_t wordval) {
   }
 }
 
+// Constant-time operations covered by test_ct_timing.
+enum { CT_ADD, CT_SUB, CT_NEGATE, CT_SELECT, CT_CSWAP, CT_CMP, CT_ROTATE, CT_MODINV, CT_NUM_OPS };
+
+#define CT_SAMPLES 100000
+#define CT_REPS 16
+
+static UInt256 ct_run(int op, UInt256 a, UInt256 b) {
+  switch (op) {
+  case CT_ADD:
+    return uint256_ct_add(a, b);
+  case CT_SUB:
+    return uint256_ct_sub(a, b);
+  case CT_NEGATE:
+    return uint256_ct_negate(a);
+  case CT_SELECT:
+    return uint256_ct_select(b.data[0] & 1, a, b);
+  case CT_CSWAP:
+    uint256_ct_cswap(b.data[0] & 1, &a, &b);
+    return a;
+  case CT_CMP:
+    return uint256_create_from_u32((uint32_t)uint256_ct_cmp(a, b));
+  case CT_MODINV:
+    // mod the secp256k1 prime; a random a is below it
+    return uint256_ct_modinv(a, uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f"));
+  default:
+    return uint256_ct_rotate_left(a, b.data[0]);
+  }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Time op on two randomly interleaved classes of inputs, dudect style:
+// class 0 is all zeros (which also means a rotate count of zero and a
+// false condition), class 1 is random. Returns Welch's t statistic for
+// the difference in mean time, ignoring the slowest 10% of samples as
+// interrupts and other noise.
+double ct_timing_t(int op) {
+  static UInt256 inputs[CT_SAMPLES][2];
+  static int classes[CT_SAMPLES];
+  static double times[CT_SAMPLES], sorted[CT_SAMPLES];
+  uint32_t x = 2463534242U;
+  for (int i = 0; i < CT_SAMPLES; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    classes[i] = x & 1;
+    for (int j = 0; j < 8; j++) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      inputs[i][0].data[j] = classes[i] ? x : 0;
+      inputs[i][1].data[j] = classes[i] ? x * 2654435761U : 0;
+    }
+  }
+
+  volatile uint32_t sink = 0;
+  for (int i = 0; i < CT_SAMPLES; i++) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < CT_REPS; r++) {
+      sink ^= ct_run(op, inputs[i][0], inputs[i][1]).data[0];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    times[i] = (double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec);
+  }
+
+  memcpy(sorted, times, sizeof(times));
+  qsort(sorted, CT_SAMPLES, sizeof(double), compare_doubles);
+  double cutoff = sorted[CT_SAMPLES * 9 / 10];
+
+  // Welford's running mean and variance for each class
+  double mean[2] = {0, 0}, m2[2] = {0, 0};
+  long count[2] = {0, 0};
+  for (int i = 0; i < CT_SAMPLES; i++) {
+    if (times[i] > cutoff) {
+      continue;
+    }
+    int c = classes[i];
+    count[c]++;
+    double delta = times[i] - mean[c];
+    mean[c] += delta / (double)count[c];
+    m2[c] += delta * (times[i] - mean[c]);
+  }
+  double var0 = m2[0] / (double)(count[0] - 1), var1 = m2[1] / (double)(count[1] - 1);
+  double se2 = var0 / (double)count[0] + var1 / (double)count[1];
+  return se2 > 0 ? (mean[0] - mean[1]) / sqrt(se2) : 0;
+}
+
 TestObjs *setup(void) {
   TestObjs *objs = (TestObjs *) malloc(sizeof(TestObjs));
 
@@ -1094,4 +1406,1603 @@ void test_uint256_create_from_hex_not_multiple_or_8() {
   ASSERT(result.data[1] == 0xab);
 }
 
+void test_uint256_create_from_hex_invalid_digits() {
+  UInt256 result;
+  result = uint256_create_from_hex("12g4");
+  ASSERT(result.data[0] == 0x12);
+  for (int i = 1; i < 8; i++) {
+    ASSERT(result.data[i] == 0);
+  }
+  result = uint256_create_from_hex("abcde12g45");
+  ASSERT(result.data[0] == 0xcde12);
+  ASSERT(result.data[1] == 0xab);
+  result = uint256_create_from_hex(" 1f");
+  ASSERT(result.data[0] == 0x1f);
+}
+
+// multiplying small values gives the ordinary product
+void test_mul_small_values() {
+  UInt256 left = uint256_create_from_u32(0xFFFFFFFFU);
+  UInt256 right = uint256_create_from_u32(0xFFFFFFFFU);
+  UInt256 result = uint256_mul(left, right);
+
+  ASSERT(0x00000001U == result.data[0]);
+  ASSERT(0xFFFFFFFEU == result.data[1]);
+  for (int i = 2; i < 8; i++) {
+    ASSERT(0U == result.data[i]);
+  }
+
+  result = uint256_mul(left, uint256_create_from_u32(0U));
+  for (int i = 0; i < 8; i++) {
+    ASSERT(0U == result.data[i]);
+  }
+}
+
+// (2^256 - 1) * (2^256 - 1) truncated to 256 bits is 1
+void test_mul_overflow_truncates() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 result = uint256_mul(max, max);
+
+  ASSERT(1U == result.data[0]);
+  for (int i = 1; i < 8; i++) {
+    ASSERT(0U == result.data[i]);
+  }
+}
+
+// multiplying two full-width values keeps the low 256 bits of the product
+void test_mul_random() {
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expected = uint256_create_from_hex("3f87f0c17faf12436b1e0c90f6e6bf1c96b428606e1e6bf5c24a442fe55618cf");
+  UInt256 result = uint256_mul(left, right);
+  ASSERT_SAME(expected, result);
+
+  // multiplication is commutative
+  result = uint256_mul(right, left);
+  ASSERT_SAME(expected, result);
+}
+
+// (2^256 - 1)^2 = (2^256 - 2) * 2^256 + 1
+void test_mul_wide_max() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt512 result = uint256_mul_wide(max, max);
+
+  ASSERT(1U == result.lo.data[0]);
+  ASSERT(0xFFFFFFFEU == result.hi.data[0]);
+  for (int i = 1; i < 8; i++) {
+    ASSERT(0U == result.lo.data[i]);
+    ASSERT(0xFFFFFFFFU == result.hi.data[i]);
+  }
+}
+
+// the full product of two full-width values
+void test_mul_wide_random() {
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expectedLo = uint256_create_from_hex("3f87f0c17faf12436b1e0c90f6e6bf1c96b428606e1e6bf5c24a442fe55618cf");
+  UInt256 expectedHi = uint256_create_from_hex("121fa000a3723a57e68984312c3a8d7ebaf36861b502e0a58f5d4c923dcb33cc");
+  UInt512 result = uint256_mul_wide(left, right);
+  ASSERT_SAME(expectedLo, result.lo);
+  ASSERT_SAME(expectedHi, result.hi);
+}
+
+// dividing by a value that fits in 32 bits (short division fast path)
+void test_divmod_by_32_bit_value() {
+  UInt256 num = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 den = uint256_create_from_u32(0xfedcba09U);
+  UInt256 expectedQuot = uint256_create_from_hex("1249249c8a0d3f3cb90e12ef6e853d312d26f55f8d029814b2393d8a");
+  UInt256 expectedRem = uint256_create_from_u32(0xe75a6015U);
+  UInt256 quot, rem;
+
+  uint256_divmod(num, den, &quot, &rem);
+  ASSERT_SAME(expectedQuot, quot);
+  ASSERT_SAME(expectedRem, rem);
+}
+
+// dividing by a value that fits in 64 bits (single limb)
+void test_divmod_by_64_bit_value() {
+  UInt256 num = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 den = uint256_create_from_hex("fedcba0987654321");
+  UInt256 expectedQuot = uint256_create_from_hex("1249249c805663c41cf07b64a2783eb4182a1797eba068c6");
+  UInt256 expectedRem = uint256_create_from_hex("317d70b875747a69");
+
+  ASSERT_SAME(expectedQuot, uint256_div(num, den));
+  ASSERT_SAME(expectedRem, uint256_mod(num, den));
+}
+
+// dividing by a multi-limb value
+void test_divmod_general() {
+  UInt256 num = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 den = uint256_create_from_hex("000000fedcba0987654321fedcba0987654321ab");
+  UInt256 expectedQuot = uint256_create_from_hex("001249249c805663c40aa756c82221da");
+  UInt256 expectedRem = uint256_create_from_hex("000000eef02aeef7c287003a094403749d741751");
+  UInt256 quot, rem;
+
+  uint256_divmod(num, den, &quot, &rem);
+  ASSERT_SAME(expectedQuot, quot);
+  ASSERT_SAME(expectedRem, rem);
+}
+
+// 2^255 / (2^191 + 1) overestimates a quotient digit, which has to be
+// corrected by adding the divisor back
+void test_divmod_add_back() {
+  UInt256 num = {0};
+  num.data[7] = 0x80000000U;
+  UInt256 den = {0};
+  den.data[0] = 1U;
+  den.data[5] = 0x80000000U;
+  UInt256 expectedQuot = uint256_create_from_hex("ffffffffffffffff");
+  UInt256 expectedRem = uint256_create_from_hex("7fffffffffffffffffffffffffffffff0000000000000001");
+  UInt256 quot, rem;
+
+  uint256_divmod(num, den, &quot, &rem);
+  ASSERT_SAME(expectedQuot, quot);
+  ASSERT_SAME(expectedRem, rem);
+}
+
+// when the numerator is smaller, the quotient is 0 and the remainder is the numerator
+void test_divmod_smaller_numerator() {
+  UInt256 num = uint256_create_from_hex("abcdef");
+  UInt256 den = uint256_create_from_hex("1234567890abcdef1234567890abcdef");
+  UInt256 zero = {0};
+  UInt256 quot, rem;
+
+  uint256_divmod(num, den, &quot, &rem);
+  ASSERT_SAME(zero, quot);
+  ASSERT_SAME(num, rem);
+}
+
+// dividing by zero gives zero for both results
+void test_divmod_by_zero() {
+  UInt256 num = uint256_create_from_hex("1234567890abcdef");
+  UInt256 zero = {0};
+  UInt256 quot, rem;
+
+  uint256_divmod(num, zero, &quot, &rem);
+  ASSERT_SAME(zero, quot);
+  ASSERT_SAME(zero, rem);
+}
+
+// Montgomery arithmetic needs an odd modulus
+void test_mont_init_rejects_even_modulus() {
+  UInt256MontCtx ctx;
+  ASSERT(0 == uint256_mont_init(&ctx, uint256_create_from_u32(10U)));
+  ASSERT(1 == uint256_mont_init(&ctx, uint256_create_from_u32(11U)));
+}
+
+// the context stores 2^512 mod n and -n^-1 mod 2^64
+void test_mont_init_precomputes_r2() {
+  UInt256MontCtx ctx;
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141");
+  UInt256 expected = uint256_create_from_hex("9d671cd581c69bc5e697f5e45bcd07c6741496c20e7cf878896cf21467d7d140");
+
+  ASSERT(1 == uint256_mont_init(&ctx, mod));
+  ASSERT_SAME(expected, ctx.r2);
+  ASSERT(0xffffffffffffffffU == (uint64_t)(ctx.n0inv * 0xbfd25e8cd0364141U));
+}
+
+// converting into and out of Montgomery form gives back the (reduced) value
+void test_mont_round_trip() {
+  UInt256MontCtx ctx;
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141");
+  UInt256 val = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  uint256_mont_init(&ctx, mod);
+
+  UInt256 result = uint256_from_mont(&ctx, uint256_to_mont(&ctx, val));
+  ASSERT_SAME(val, result);
+
+  result = uint256_from_mont(&ctx, uint256_to_mont(&ctx, mod));
+  UInt256 zero = {0};
+  ASSERT_SAME(zero, result);
+}
+
+// multiplying in Montgomery form matches (a * b) mod n
+void test_mont_mul() {
+  UInt256MontCtx ctx;
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141");
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expected = uint256_create_from_hex("f98f7d20ac3698c87edae71c5a4709c495593962d6c397bad9a1b3edb5d15217");
+  uint256_mont_init(&ctx, mod);
+
+  UInt256 product = uint256_mont_mul(&ctx, uint256_to_mont(&ctx, left), uint256_to_mont(&ctx, right));
+  UInt256 result = uint256_from_mont(&ctx, product);
+  ASSERT_SAME(expected, result);
+}
+
+// squaring in Montgomery form matches (a * a) mod n
+void test_mont_sqr() {
+  UInt256MontCtx ctx;
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141");
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 expected = uint256_create_from_hex("e1e3d31a5ae70e7c91e770bdfbf08956fdc4e874a097dcdc4fce73f89812da77");
+  uint256_mont_init(&ctx, mod);
+
+  UInt256 valMont = uint256_to_mont(&ctx, val);
+  UInt256 result = uint256_from_mont(&ctx, uint256_mont_sqr(&ctx, valMont));
+  ASSERT_SAME(expected, result);
+
+  // squaring agrees with multiplying a value by itself
+  ASSERT_SAME(uint256_mont_mul(&ctx, valMont, valMont), uint256_mont_sqr(&ctx, valMont));
+}
+
+// multiplying modulo a prime uses the full 512-bit product
+void test_mulmod() {
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f");
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expected = uint256_create_from_hex("0dabcd892d293feb6a2a19b97d502825c6a865e9cd771060354652a4e4897181");
+  UInt256 zero = {0};
+
+  ASSERT_SAME(expected, uint256_mulmod(left, right, mod));
+  ASSERT_SAME(zero, uint256_mulmod(left, right, zero));
+}
+
+// exponentiation with small operands, a zero exponent and a modulus of 1
+void test_modexp_small_values() {
+  UInt256 base = uint256_create_from_u32(3U);
+  UInt256 mod = uint256_create_from_u32(1000U);
+  UInt256 result;
+
+  // 3^13 = 1594323
+  result = uint256_modexp(base, uint256_create_from_u32(13U), mod);
+  ASSERT_SAME(uint256_create_from_u32(323U), result);
+
+  result = uint256_modexp(base, uint256_create_from_u32(0U), mod);
+  ASSERT_SAME(uint256_create_from_u32(1U), result);
+
+  result = uint256_modexp(base, uint256_create_from_u32(13U), uint256_create_from_u32(1U));
+  ASSERT_SAME(uint256_create_from_u32(0U), result);
+}
+
+// full-width exponent with an odd (Montgomery) modulus
+void test_modexp_odd_modulus() {
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f");
+  UInt256 base = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 exp = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expected = uint256_create_from_hex("b4326dd5133172bbb55e3076888928b6acf93b7d859f5c30f0760d1e90b1d978");
+
+  ASSERT_SAME(expected, uint256_modexp(base, exp, mod));
+}
+
+// full-width exponent with an even modulus (2^200 + 6)
+void test_modexp_even_modulus() {
+  UInt256 mod = {0};
+  mod.data[0] = 6U;
+  mod.data[6] = 0x100U;
+  UInt256 base = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 exp = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expected = uint256_create_from_hex("00000000000000f62e054213d189fc50278a5fec148afa6018b81f6fc78cab95");
+
+  ASSERT_SAME(expected, uint256_modexp(base, exp, mod));
+}
+
+// a^(p - 1) = 1 (mod p) for a prime p
+void test_modexp_fermat() {
+  UInt256 p = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f");
+  UInt256 pMinusOne = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e");
+  UInt256 base = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_modexp(base, pMinusOne, p));
+}
+
+// the fixed-base table gives the same results as uint256_modexp
+void test_fixed_base_exp() {
+  static UInt256FixedBase fb;
+  UInt256 mod = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f");
+  UInt256 base = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 exp = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 expected = uint256_create_from_hex("b4326dd5133172bbb55e3076888928b6acf93b7d859f5c30f0760d1e90b1d978");
+
+  ASSERT(0 == uint256_fixed_base_init(&fb, base, uint256_create_from_u32(1000U)));
+  ASSERT(1 == uint256_fixed_base_init(&fb, base, mod));
+  ASSERT_SAME(expected, uint256_fixed_base_exp(&fb, exp));
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_fixed_base_exp(&fb, uint256_create_from_u32(0U)));
+  ASSERT_SAME(base, uint256_fixed_base_exp(&fb, uint256_create_from_u32(1U)));
+}
+
+// addition and subtraction modulo the secp256k1 prime wrap around p
+void test_fp_k1_add_sub() {
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 pMinusOne = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e");
+
+  ASSERT_SAME(uint256_create_from_hex("11111082181111111111108218111111111110821811111111111083181114e1"),
+              uint256_fp_k1_add(left, right));
+  ASSERT_SAME(uint256_create_from_hex("13579c6f09468acd13579c6f09468acd13579c6f09468acd13579c6e094686fd"),
+              uint256_fp_k1_sub(left, right));
+  ASSERT_SAME(uint256_create_from_hex("eca86390f6b97532eca86390f6b97532eca86390f6b97532eca86390f6b97532"),
+              uint256_fp_k1_sub(right, left));
+  ASSERT_SAME(uint256_create_from_u32(0U), uint256_fp_k1_add(pMinusOne, uint256_create_from_u32(1U)));
+  ASSERT_SAME(pMinusOne, uint256_fp_k1_sub(uint256_create_from_u32(0U), uint256_create_from_u32(1U)));
+}
+
+// multiplication and squaring modulo the secp256k1 prime
+void test_fp_k1_mul_sqr() {
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 pMinusOne = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e");
+
+  ASSERT_SAME(uint256_create_from_hex("0dabcd892d293feb6a2a19b97d502825c6a865e9cd771060354652a4e4897181"),
+              uint256_fp_k1_mul(left, right));
+  ASSERT_SAME(uint256_create_from_hex("c04b67d4a5e4b37c7558b1f031a856712a65fc0bbd6bf965e0bead0c9a5cbc37"),
+              uint256_fp_k1_sqr(left));
+  // (-1)^2 = 1
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_fp_k1_sqr(pMinusOne));
+}
+
+// a value times its inverse modulo the secp256k1 prime is 1
+void test_fp_k1_inv() {
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 inv = uint256_fp_k1_inv(val);
+
+  ASSERT_SAME(uint256_create_from_hex("12f1627c2951be2f8a39b867e4368d3f6495f48c67a920ad74ddbf3fe1a798da"), inv);
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_fp_k1_mul(val, inv));
+  ASSERT_SAME(uint256_create_from_u32(0U), uint256_fp_k1_inv(uint256_create_from_u32(0U)));
+}
+
+// addition and subtraction modulo the P-256 prime wrap around p
+void test_fp_p256_add_sub() {
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 pMinusOne = uint256_create_from_hex("ffffffff00000001000000000000000000000000fffffffffffffffffffffffe");
+
+  ASSERT_SAME(uint256_create_from_hex("1111108318111110111110821811111111111081181111111111108218111111"),
+              uint256_fp_p256_add(left, right));
+  ASSERT_SAME(uint256_create_from_hex("13579c6e09468ace13579c6f09468acd13579c7009468acd13579c6f09468acd"),
+              uint256_fp_p256_sub(left, right));
+  ASSERT_SAME(uint256_create_from_hex("eca86390f6b97532eca86390f6b97532eca86390f6b97532eca86390f6b97532"),
+              uint256_fp_p256_sub(right, left));
+  ASSERT_SAME(uint256_create_from_u32(0U), uint256_fp_p256_add(pMinusOne, uint256_create_from_u32(1U)));
+  ASSERT_SAME(pMinusOne, uint256_fp_p256_sub(uint256_create_from_u32(0U), uint256_create_from_u32(1U)));
+}
+
+// multiplication and squaring modulo the P-256 prime
+void test_fp_p256_mul_sqr() {
+  UInt256 left = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 right = uint256_create_from_hex("fedcba0987654321fedcba0987654321fedcba0987654321fedcba0987654321");
+  UInt256 pMinusOne = uint256_create_from_hex("ffffffff00000001000000000000000000000000fffffffffffffffffffffffe");
+
+  ASSERT_SAME(uint256_create_from_hex("30f7a9d8a7a6051f213ee09c7b80ef9c6c5177f341f956733e54855f4154e4c4"),
+              uint256_fp_p256_mul(left, right));
+  ASSERT_SAME(uint256_create_from_hex("750a9d28bb7438877f96458f0cb1334bfb587276c9aa6dc39714291a1a14b143"),
+              uint256_fp_p256_sqr(left));
+  // (-1)^2 = 1
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_fp_p256_sqr(pMinusOne));
+}
+
+// a value times its inverse modulo the P-256 prime is 1
+void test_fp_p256_inv() {
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 inv = uint256_fp_p256_inv(val);
+
+  ASSERT_SAME(uint256_create_from_hex("8056a93bbc74c29585a874f6b858572477c5f7aa71a2d0b0416f09ed94008b74"), inv);
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_fp_p256_mul(val, inv));
+  ASSERT_SAME(uint256_create_from_u32(0U), uint256_fp_p256_inv(uint256_create_from_u32(0U)));
+}
+
+// adding into one of the operands
+void test_add_to_in_place() {
+  UInt256 acc = {0};
+  acc.data[0] = 0xFFFFFFFFU;
+  acc.data[1] = 0xFFFFFFFFU;
+  UInt256 one = uint256_create_from_u32(1U);
+
+  uint256_add_to(&acc, &acc, &one);
+  ASSERT(0U == acc.data[0]);
+  ASSERT(0U == acc.data[1]);
+  ASSERT(1U == acc.data[2]);
+
+  // doubling a value by adding it to itself
+  uint256_add_to(&acc, &acc, &acc);
+  ASSERT(2U == acc.data[2]);
+}
+
+// subtracting propagates the borrow through every word
+void test_sub_to_borrow() {
+  UInt256 left = {0};
+  left.data[7] = 1U;
+  UInt256 right = uint256_create_from_u32(1U);
+  UInt256 result;
+
+  uint256_sub_to(&result, &left, &right);
+  for (int i = 0; i < 7; i++) {
+    ASSERT(0xFFFFFFFFU == result.data[i]);
+  }
+  ASSERT(0U == result.data[7]);
+
+  uint256_sub_to(&right, &left, &right);
+  ASSERT_SAME(result, right);
+}
+
+// negating a value in place
+void test_negate_to_in_place() {
+  UInt256 val = uint256_create_from_u32(1U);
+
+  uint256_negate_to(&val, &val);
+  for (int i = 0; i < 8; i++) {
+    ASSERT(0xFFFFFFFFU == val.data[i]);
+  }
+  uint256_negate_to(&val, &val);
+  ASSERT_SAME(uint256_create_from_u32(1U), val);
+}
+
+// squaring a value in place with uint256_mul_to
+void test_mul_to_in_place() {
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 expected = uint256_mul(val, val);
+
+  uint256_mul_to(&val, &val, &val);
+  ASSERT_SAME(expected, val);
+}
+
+// rotating a value in place in both directions
+void test_rotate_to_in_place() {
+  uint32_t rot_data[8] = { 0x000000ABU, 0U, 0U, 0U, 0U, 0U, 0U, 0xCD000000U };
+  UInt256 val;
+  INIT_FROM_ARR(val, rot_data);
+
+  uint256_rotate_left_to(&val, &val, 4);
+  ASSERT(0x00000ABCU == val.data[0]);
+  ASSERT(0xD0000000U == val.data[7]);
+
+  uint256_rotate_right_to(&val, &val, 4);
+  ASSERT(0x000000ABU == val.data[0]);
+  ASSERT(0xCD000000U == val.data[7]);
+}
+
+// carries ripple across both 32-bit word and 64-bit limb boundaries
+void test_add_carry_chain_across_limbs() {
+  UInt256 left = uint256_create_from_hex("ffffffff00000000ffffffffffffffff00000000ffffffff0000000000000001");
+  UInt256 right = uint256_create_from_hex("00000000ffffffff00000000000000010000000000000000ffffffffffffffff");
+  UInt256 expected = uint256_create_from_hex("0000000000000000000000000000000000000001000000000000000000000000");
+
+  ASSERT_SAME(expected, uint256_add(left, right));
+  ASSERT_SAME(expected, uint256_add(right, left));
+}
+
+// borrows ripple across both 32-bit word and 64-bit limb boundaries
+void test_sub_borrow_chain_across_limbs() {
+  UInt256 left = uint256_create_from_hex("00000000ffffffff00000000000000010000000000000000ffffffffffffffff");
+  UInt256 right = uint256_create_from_hex("ffffffff00000000ffffffffffffffff00000000ffffffff0000000000000001");
+  UInt256 expected = uint256_create_from_hex("00000001fffffffe0000000000000001ffffffff00000001fffffffffffffffe");
+
+  ASSERT_SAME(expected, uint256_sub(left, right));
+  ASSERT_SAME(left, uint256_add(uint256_sub(left, right), right));
+}
+
+// the incoming carry is added and the outgoing carry is reported
+void test_add_carry_in_and_out() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 zero = {0};
+  unsigned carry;
+
+  UInt256 result = uint256_add_carry(max, zero, 1, &carry);
+  ASSERT_SAME(zero, result);
+  ASSERT(1U == carry);
+
+  result = uint256_add_carry(max, max, 1, &carry);
+  ASSERT_SAME(max, result);
+  ASSERT(1U == carry);
+
+  result = uint256_add_carry(zero, zero, 1, &carry);
+  ASSERT_SAME(uint256_create_from_u32(1U), result);
+  ASSERT(0U == carry);
+}
+
+// the incoming borrow is subtracted and the outgoing borrow is reported
+void test_sub_borrow_in_and_out() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 zero = {0};
+  unsigned borrow;
+
+  UInt256 result = uint256_sub_borrow(zero, zero, 1, &borrow);
+  ASSERT_SAME(max, result);
+  ASSERT(1U == borrow);
+
+  result = uint256_sub_borrow(max, max, 0, &borrow);
+  ASSERT_SAME(zero, result);
+  ASSERT(0U == borrow);
+
+  result = uint256_sub_borrow(zero, max, 1, NULL);
+  ASSERT_SAME(zero, result);
+}
+
+// adding 512-bit values carries from the low half into the high half
+void test_uint512_add() {
+  UInt512 left, right;
+  set_all(&left.lo, 0xFFFFFFFFU);
+  set_all(&left.hi, 0U);
+  right.lo = uint256_create_from_u32(1U);
+  right.hi = uint256_create_from_u32(2U);
+
+  UInt512 result = uint512_add(left, right);
+  ASSERT_SAME(uint256_create_from_u32(0U), result.lo);
+  ASSERT_SAME(uint256_create_from_u32(3U), result.hi);
+}
+
+// subtracting 512-bit values borrows from the high half
+void test_uint512_sub() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt512 left, right;
+  left.lo = uint256_create_from_u32(0U);
+  left.hi = uint256_create_from_u32(1U);
+  right.lo = uint256_create_from_u32(1U);
+  right.hi = uint256_create_from_u32(0U);
+
+  UInt512 result = uint512_sub(left, right);
+  ASSERT_SAME(max, result.lo);
+  ASSERT_SAME(uint256_create_from_u32(0U), result.hi);
+
+  // (2^256 - 1)^2 - 1 = (2^256 - 2) * 2^256
+  UInt512 square = uint256_mul_wide(max, max);
+  result = uint512_sub(square, right);
+  ASSERT_SAME(uint256_create_from_u32(0U), result.lo);
+  ASSERT_SAME(square.hi, result.hi);
+}
+
+// shifting left discards the bits moved past the most significant bit
+void test_shl() {
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+
+  ASSERT_SAME(val, uint256_shl(val, 0));
+  ASSERT_SAME(uint256_create_from_hex("234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef0"),
+              uint256_shl(val, 4));
+  ASSERT_SAME(uint256_create_from_hex("0abcdef1234567890abcdef1234567890abcdef0000000000000000000000000"),
+              uint256_shl(val, 100));
+
+  UInt256 msb = {0};
+  msb.data[7] = 0x80000000U;
+  ASSERT_SAME(msb, uint256_shl(uint256_create_from_u32(1U), 255));
+}
+
+// shifting right fills the most significant bits with zeros
+void test_shr() {
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+
+  ASSERT_SAME(val, uint256_shr(val, 0));
+  ASSERT_SAME(uint256_create_from_hex("01234567890abcdef1234567890abcdef1234567890abcdef1234567890abcde"),
+              uint256_shr(val, 4));
+  ASSERT_SAME(uint256_create_from_hex("00000000000000000000000001234567890abcdef1234567890abcdef1234567"),
+              uint256_shr(val, 100));
+
+  UInt256 msb = {0};
+  msb.data[7] = 0x80000000U;
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_shr(msb, 255));
+}
 
+// shift counts of 256 or more clear every bit
+void test_shift_by_256_or_more() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 zero = {0};
+
+  ASSERT_SAME(zero, uint256_shl(max, 256));
+  ASSERT_SAME(zero, uint256_shr(max, 256));
+  ASSERT_SAME(zero, uint256_shl(max, 1000));
+  ASSERT_SAME(zero, uint256_shr(max, 0xFFFFFFFFU));
+}
+
+// rotating by whole 64-bit limbs only moves limbs
+void test_rotate_by_limb_multiples() {
+  UInt256 val = uint256_create_from_hex("4444444444444444333333333333333322222222222222221111111111111111");
+
+  ASSERT_SAME(uint256_create_from_hex("3333333333333333222222222222222211111111111111114444444444444444"),
+              uint256_rotate_left(val, 64));
+  ASSERT_SAME(uint256_create_from_hex("1111111111111111444444444444444433333333333333332222222222222222"),
+              uint256_rotate_right(val, 64));
+  ASSERT_SAME(uint256_rotate_left(val, 192), uint256_rotate_right(val, 64));
+}
+
+// batch operations match the single-value operations element by element
+void test_batch_add_sub_negate() {
+  UInt256 left[5], right[5], out[5];
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 8; j++) {
+      left[i].data[j] = 0x9E3779B9U * (uint32_t)(i * 8 + j + 1);
+      right[i].data[j] = 0x85EBCA6BU * (uint32_t)(i * 8 + j + 3);
+    }
+  }
+  set_all(&left[4], 0xFFFFFFFFU);
+  right[4] = uint256_create_from_u32(1U);
+
+  uint256_add_batch(out, left, right, 5);
+  for (int i = 0; i < 5; i++) {
+    ASSERT_SAME(uint256_add(left[i], right[i]), out[i]);
+  }
+  uint256_sub_batch(out, left, right, 5);
+  for (int i = 0; i < 5; i++) {
+    ASSERT_SAME(uint256_sub(left[i], right[i]), out[i]);
+  }
+  uint256_negate_batch(out, left, 5);
+  for (int i = 0; i < 5; i++) {
+    ASSERT_SAME(uint256_negate(left[i]), out[i]);
+  }
+
+  // in place
+  uint256_add_batch(out, out, left, 5);
+  UInt256 zero = {0};
+  for (int i = 0; i < 5; i++) {
+    ASSERT_SAME(zero, out[i]);
+  }
+}
+
+// structure-of-arrays operations, over more values than one kernel block
+void test_soa_add_sub_negate() {
+  enum { N = 300 };
+  static uint32_t aw[8][N], bw[8][N], ow[8][N];
+  static UInt256 left[N], right[N], out[N];
+  UInt256SoA a, b, o;
+  for (int i = 0; i < 8; i++) {
+    a.words[i] = aw[i];
+    b.words[i] = bw[i];
+    o.words[i] = ow[i];
+  }
+  for (int j = 0; j < N; j++) {
+    for (int i = 0; i < 8; i++) {
+      left[j].data[i] = 0x9E3779B9U * (uint32_t)(j * 8 + i + 1);
+      right[j].data[i] = (j % 3 == 0) ? 0xFFFFFFFFU : 0x85EBCA6BU * (uint32_t)(j * 8 + i + 5);
+    }
+  }
+  uint256_soa_load(&a, left, N);
+  uint256_soa_load(&b, right, N);
+
+  uint256_soa_add(&o, &a, &b, N);
+  uint256_soa_store(out, &o, N);
+  for (int j = 0; j < N; j++) {
+    ASSERT_SAME(uint256_add(left[j], right[j]), out[j]);
+  }
+  uint256_soa_sub(&o, &a, &b, N);
+  uint256_soa_store(out, &o, N);
+  for (int j = 0; j < N; j++) {
+    ASSERT_SAME(uint256_sub(left[j], right[j]), out[j]);
+  }
+  uint256_soa_negate(&o, &b, N);
+  uint256_soa_store(out, &o, N);
+  for (int j = 0; j < N; j++) {
+    ASSERT_SAME(uint256_negate(right[j]), out[j]);
+  }
+
+  // in place: a = a + b, then a = a - b gives back left
+  uint256_soa_add(&a, &a, &b, N);
+  uint256_soa_sub(&a, &a, &b, N);
+  uint256_soa_store(out, &a, N);
+  for (int j = 0; j < N; j++) {
+    ASSERT_SAME(left[j], out[j]);
+  }
+}
+
+// formatting into a caller buffer, including the too-small case
+void test_format_hex_into() {
+  char buf[UINT256_HEX_BUFSIZE];
+
+  ASSERT(1 == uint256_format_hex_into(uint256_create_from_u32(0U), buf, sizeof(buf)));
+  ASSERT(0 == strcmp("0", buf));
+
+  UInt256 val = {0};
+  val.data[4] = 0xabcU;
+  val.data[0] = 0x1U;
+  ASSERT(35 == uint256_format_hex_into(val, buf, sizeof(buf)));
+  ASSERT(0 == strcmp("abc00000000000000000000000000000001", buf));
+
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  ASSERT(64 == uint256_format_hex_into(max, buf, sizeof(buf)));
+  ASSERT(0 == strcmp("ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", buf));
+
+  // no room for the NUL
+  strcpy(buf, "xyz");
+  ASSERT(0 == uint256_format_hex_into(uint256_create_from_u32(0x123U), buf, 3));
+  ASSERT(0 == strcmp("xyz", buf));
+  ASSERT(3 == uint256_format_hex_into(uint256_create_from_u32(0x123U), buf, 4));
+  ASSERT(0 == strcmp("123", buf));
+}
+
+// parsing with an explicit length, an optional prefix and mixed case
+void test_parse_hex() {
+  UInt256 val;
+
+  ASSERT(UINT256_PARSE_OK == uint256_parse_hex("0xAbC", 5, &val));
+  ASSERT_SAME(uint256_create_from_u32(0xabcU), val);
+
+  // only the first len characters are read
+  ASSERT(UINT256_PARSE_OK == uint256_parse_hex("123456789zzz", 9, &val));
+  UInt256 expected = {0};
+  expected.data[1] = 0x1U;
+  expected.data[0] = 0x23456789U;
+  ASSERT_SAME(expected, val);
+
+  // more than 64 digits keeps the last 64
+  const char *longHex = "0X71234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef";
+  ASSERT(UINT256_PARSE_OK == uint256_parse_hex(longHex, strlen(longHex), &val));
+  ASSERT_SAME(uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef"), val);
+
+  // odd lengths
+  ASSERT_SAME(uint256_create_from_hex("0123456789"), uint256_create_from_hex("123456789"));
+  expected.data[1] = 0x12U;
+  expected.data[0] = 0x3456789aU;
+  ASSERT_SAME(expected, uint256_create_from_hex("123456789a"));
+}
+
+// empty input and invalid characters are reported, leaving *out alone
+void test_parse_hex_errors() {
+  UInt256 val = uint256_create_from_u32(7U);
+
+  ASSERT(UINT256_PARSE_EMPTY == uint256_parse_hex("", 0, &val));
+  ASSERT(UINT256_PARSE_EMPTY == uint256_parse_hex("0x", 2, &val));
+  ASSERT(UINT256_PARSE_INVALID_DIGIT == uint256_parse_hex("12g4", 4, &val));
+  ASSERT(UINT256_PARSE_INVALID_DIGIT == uint256_parse_hex(" 1", 2, &val));
+  ASSERT(UINT256_PARSE_INVALID_DIGIT == uint256_parse_hex("0x0x1", 5, &val));
+  ASSERT_SAME(uint256_create_from_u32(7U), val);
+
+  // an invalid character before the last 64 digits is still an error
+  char longHex[70];
+  memset(longHex, 'f', sizeof(longHex));
+  longHex[1] = '-';
+  ASSERT(UINT256_PARSE_INVALID_DIGIT == uint256_parse_hex(longHex, sizeof(longHex), &val));
+
+  ASSERT_SAME(uint256_create_from_u32(0U), uint256_create_from_hex("xyz"));
+}
+
+// fixed-width batch formatting and parsing round trip
+void test_hex_batch_round_trip() {
+  UInt256 vals[4], parsed[4];
+  char text[64 * 4];
+  set_all(&vals[0], 0U);
+  set_all(&vals[1], 0xFFFFFFFFU);
+  for (int i = 0; i < 8; i++) {
+    vals[2].data[i] = 0x01234567U + 0x11111111U * (uint32_t)i;
+    vals[3].data[i] = 0xfedcba98U - 0x10101010U * (uint32_t)i;
+  }
+
+  uint256_format_hex_batch(text, vals, 4);
+  ASSERT(0 == memcmp(text, "0000000000000000000000000000000000000000000000000000000000000000", 64));
+  ASSERT(0 == memcmp(text + 64, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", 64));
+  char single[UINT256_HEX_BUFSIZE];
+  for (int i = 2; i < 4; i++) {
+    ASSERT(64 == uint256_format_hex_into(vals[i], single, sizeof(single)));
+    ASSERT(0 == memcmp(text + 64 * i, single, 64));
+  }
+
+  ASSERT(4 == uint256_parse_hex_batch(parsed, text, 4));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_SAME(vals[i], parsed[i]);
+  }
+
+  // uppercase digits parse too
+  for (int i = 0; i < 64; i++) {
+    text[64 + i] = 'F';
+  }
+  ASSERT(2 == uint256_parse_hex_batch(parsed, text, 2));
+  ASSERT_SAME(vals[1], parsed[1]);
+}
+
+// parsing stops at the first record with a bad character
+void test_parse_hex_batch_invalid() {
+  const char *bad = "g/:@`G \x80\xff";
+  char text[64 * 3];
+  UInt256 parsed[3];
+  memset(text, 'a', sizeof(text));
+
+  for (const char *p = bad; *p != '\0'; p++) {
+    for (int pos = 0; pos < 64; pos += 21) {
+      memset(text, 'a', sizeof(text));
+      text[64 + pos] = *p;
+      ASSERT(1 == uint256_parse_hex_batch(parsed, text, 3));
+    }
+  }
+  text[64 + 63] = (char)0xC1;
+  ASSERT(1 == uint256_parse_hex_batch(parsed, text, 3));
+  text[64 + 63] = 'a';
+  ASSERT(3 == uint256_parse_hex_batch(parsed, text, 3));
+}
+
+// decimal formatting, including chunk boundaries and the largest value
+void test_format_dec() {
+  char buf[UINT256_DEC_BUFSIZE];
+
+  ASSERT(1 == uint256_format_dec_into(uint256_create_from_u32(0U), buf, sizeof(buf)));
+  ASSERT(0 == strcmp("0", buf));
+
+  // 10^19 - 1 and 10^19
+  UInt256 val = uint256_create_from_hex("8ac7230489e7ffff");
+  ASSERT(19 == uint256_format_dec_into(val, buf, sizeof(buf)));
+  ASSERT(0 == strcmp("9999999999999999999", buf));
+  val = uint256_create_from_hex("8ac7230489e80000");
+  ASSERT(20 == uint256_format_dec_into(val, buf, sizeof(buf)));
+  ASSERT(0 == strcmp("10000000000000000000", buf));
+
+  // 10^38 + 7, so the middle chunk is all zeros
+  val = uint256_create_from_hex("4b3b4ca85a86c47a098a224000000007");
+  char *dec = uint256_format_as_dec(val);
+  ASSERT(0 == strcmp("100000000000000000000000000000000000007", dec));
+  free(dec);
+
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  ASSERT(78 == uint256_format_dec_into(max, buf, sizeof(buf)));
+  ASSERT(0 == strcmp("115792089237316195423570985008687907853269984665640564039457584007913129639935", buf));
+
+  // too small leaves buf untouched
+  strcpy(buf, "xyz");
+  ASSERT(0 == uint256_format_dec_into(max, buf, 78));
+  ASSERT(0 == strcmp("xyz", buf));
+}
+
+// decimal parsing and its error cases
+void test_parse_dec() {
+  UInt256 val;
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+
+  const char *maxDec = "115792089237316195423570985008687907853269984665640564039457584007913129639935";
+  ASSERT(UINT256_PARSE_OK == uint256_parse_dec(maxDec, strlen(maxDec), &val));
+  ASSERT_SAME(max, val);
+  ASSERT_SAME(uint256_create_from_hex("4b3b4ca85a86c47a098a224000000007"),
+              uint256_create_from_dec("100000000000000000000000000000000000007"));
+
+  // only len characters are read, and leading zeros are fine
+  ASSERT(UINT256_PARSE_OK == uint256_parse_dec("1234x", 4, &val));
+  ASSERT_SAME(uint256_create_from_u32(1234U), val);
+  ASSERT_SAME(uint256_create_from_u32(42U),
+              uint256_create_from_dec("0000000000000000000000000000000000000000000000000000000000000000000000000000000000000042"));
+
+  val = uint256_create_from_u32(7U);
+  ASSERT(UINT256_PARSE_EMPTY == uint256_parse_dec("", 0, &val));
+  ASSERT(UINT256_PARSE_INVALID_DIGIT == uint256_parse_dec("12a", 3, &val));
+  ASSERT(UINT256_PARSE_INVALID_DIGIT == uint256_parse_dec("-1", 2, &val));
+  // 2^256
+  const char *tooBig = "115792089237316195423570985008687907853269984665640564039457584007913129639936";
+  ASSERT(UINT256_PARSE_OVERFLOW == uint256_parse_dec(tooBig, strlen(tooBig), &val));
+  ASSERT_SAME(uint256_create_from_u32(7U), val);
+}
+
+// byte loads and stores in both byte orders
+void test_load_store_bytes() {
+  uint8_t bytes[33];
+  for (int i = 0; i < 33; i++) {
+    bytes[i] = (uint8_t)(i + 1);
+  }
+  // read from an odd address
+  UInt256 be = uint256_load_be(bytes + 1);
+  UInt256 le = uint256_load_le(bytes + 1);
+  ASSERT_SAME(uint256_create_from_hex("02030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f2021"), be);
+  ASSERT_SAME(uint256_create_from_hex("21201f1e1d1c1b1a191817161514131211100f0e0d0c0b0a0908070605040302"), le);
+  ASSERT(0x1e1f2021U == be.data[0]);
+  ASSERT(0x05040302U == le.data[0]);
+
+  uint8_t out[33] = {0};
+  uint256_store_be(be, out + 1);
+  ASSERT(0 == memcmp(bytes + 1, out + 1, 32));
+  memset(out, 0, sizeof(out));
+  uint256_store_le(le, out + 1);
+  ASSERT(0 == memcmp(bytes + 1, out + 1, 32));
+  ASSERT(0 == out[0]);
+}
+
+// batch loads and stores over packed records
+void test_load_store_batch() {
+  uint8_t bytes[96], out[96];
+  for (int i = 0; i < 96; i++) {
+    bytes[i] = (uint8_t)(7 * i + 3);
+  }
+  UInt256 vals[3];
+
+  uint256_load_be_batch(vals, bytes, 3);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_SAME(uint256_load_be(bytes + 32 * i), vals[i]);
+  }
+  uint256_store_be_batch(out, vals, 3);
+  ASSERT(0 == memcmp(bytes, out, sizeof(out)));
+
+  uint256_load_le_batch(vals, bytes, 3);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_SAME(uint256_load_le(bytes + 32 * i), vals[i]);
+  }
+  uint256_store_le_batch(out, vals, 3);
+  ASSERT(0 == memcmp(bytes, out, sizeof(out)));
+}
+
+// varint sizes grow with the value and decode back exactly
+void test_varint_round_trip() {
+  uint8_t buf[UINT256_VARINT_MAX + 8];
+  UInt256 val;
+
+  ASSERT(1 == uint256_encode_varint(uint256_create_from_u32(0U), buf, sizeof(buf)));
+  ASSERT(0 == buf[0]);
+
+  ASSERT(3 == uint256_encode_varint(uint256_create_from_u32(0x1234U), buf, sizeof(buf)));
+  ASSERT(2 == buf[0] && 0x34 == buf[1] && 0x12 == buf[2]);
+  // exactly three bytes available takes the short path
+  ASSERT(3 == uint256_decode_varint(buf, 3, &val));
+  ASSERT_SAME(uint256_create_from_u32(0x1234U), val);
+
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  ASSERT(33 == uint256_encode_varint(max, buf, sizeof(buf)));
+  ASSERT(33 == uint256_decode_varint(buf, sizeof(buf), &val));
+  ASSERT_SAME(max, val);
+
+  // a value with a zero word below the top one
+  UInt256 sparse = {0};
+  sparse.data[5] = 0x80U;
+  sparse.data[0] = 0x1U;
+  ASSERT(22 == uint256_encode_varint(sparse, buf, sizeof(buf)));
+  memset(buf + 22, 0xAA, sizeof(buf) - 22);
+  ASSERT(22 == uint256_decode_varint(buf, sizeof(buf), &val));
+  ASSERT_SAME(sparse, val);
+
+  // a batch of mixed sizes
+  UInt256 vals[4] = {max, sparse, {{0}}, {{5}}};
+  uint8_t stream[4 * UINT256_VARINT_MAX];
+  size_t used = 0;
+  for (int i = 0; i < 4; i++) {
+    used += uint256_encode_varint(vals[i], stream + used, sizeof(stream) - used);
+  }
+  ASSERT(33 + 22 + 1 + 2 == used);
+  UInt256 decoded[4];
+  ASSERT(used == uint256_decode_varint_batch(decoded, 4, stream, used));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_SAME(vals[i], decoded[i]);
+  }
+}
+
+// malformed and truncated varints are rejected
+void test_varint_errors() {
+  uint8_t buf[40] = {0};
+  UInt256 val = uint256_create_from_u32(7U);
+
+  ASSERT(0 == uint256_encode_varint(uint256_create_from_u32(0x1234U), buf, 2));
+  ASSERT(0 == uint256_decode_varint(buf, 0, &val));
+
+  buf[0] = 33;  // count too large
+  ASSERT(0 == uint256_decode_varint(buf, sizeof(buf), &val));
+  buf[0] = 2;   // truncated
+  buf[1] = 1;
+  buf[2] = 1;
+  ASSERT(0 == uint256_decode_varint(buf, 2, &val));
+  buf[2] = 0;   // not minimal
+  ASSERT(0 == uint256_decode_varint(buf, sizeof(buf), &val));
+  ASSERT_SAME(uint256_create_from_u32(7U), val);
+
+  // the second of two varints is truncated
+  uint8_t stream[4] = {1, 9, 2, 1};
+  UInt256 decoded[2];
+  ASSERT(0 == uint256_decode_varint_batch(decoded, 2, stream, sizeof(stream)));
+}
+
+// comparisons decided by the most significant differing limb
+void test_cmp_eq_lt() {
+  UInt256 small = uint256_create_from_hex("ffffffffffffffffffffffffffffffffffffffffffffffff");
+  UInt256 big = uint256_create_from_hex("1000000000000000000000000000000000000000000000000");
+  UInt256 zero = {0};
+
+  ASSERT(-1 == uint256_cmp(small, big));
+  ASSERT(1 == uint256_cmp(big, small));
+  ASSERT(0 == uint256_cmp(big, big));
+  ASSERT(-1 == uint256_ct_cmp(small, big));
+  ASSERT(1 == uint256_ct_cmp(big, small));
+  ASSERT(0 == uint256_ct_cmp(big, big));
+
+  ASSERT(uint256_lt(small, big));
+  ASSERT(!uint256_lt(big, small));
+  ASSERT(!uint256_lt(big, big));
+  ASSERT(uint256_lt(zero, big));
+
+  ASSERT(uint256_eq(zero, zero));
+  ASSERT(!uint256_eq(small, big));
+  UInt256 topBit = {0};
+  topBit.data[7] = 0x80000000U;
+  ASSERT(!uint256_eq(zero, topBit));
+  ASSERT(1 == uint256_cmp(topBit, small));
+}
+
+// min and max over arrays, including ties in the top word
+void test_min_max_index() {
+  UInt256 vals[6];
+  for (int i = 0; i < 6; i++) {
+    set_all(&vals[i], 0U);
+    vals[i].data[7] = 5U;
+    vals[i].data[0] = (uint32_t)(10 - i);
+  }
+  vals[2].data[7] = 4U;
+  vals[4].data[0] = 100U;
+
+  ASSERT(4 == uint256_max_index(vals, 6));
+  ASSERT(2 == uint256_min_index(vals, 6));
+  ASSERT(0 == uint256_max_index(vals, 1));
+  ASSERT(0 == uint256_min_index(vals, 1));
+  // no values: vals isn't read
+  ASSERT(0 == uint256_max_index(NULL, 0));
+  ASSERT(0 == uint256_min_index(NULL, 0));
+
+  // ties go to the first occurrence
+  vals[1] = vals[4];
+  ASSERT(1 == uint256_max_index(vals, 6));
+  vals[5] = vals[2];
+  ASSERT(2 == uint256_min_index(vals, 6));
+}
+
+// values below 2^224 all share a zero top word, so every word takes
+// part in the comparisons; checked against a plain scan
+void test_min_max_index_equal_top_words() {
+  enum { N = 203 };
+  static UInt256 vals[N];
+  uint32_t seed = 12345U;
+  for (int i = 0; i < N; i++) {
+    for (int w = 0; w < 7; w++) {
+      seed = seed * 1103515245U + 12345U;
+      vals[i].data[w] = w == 6 ? seed % 3 : seed;
+    }
+    vals[i].data[7] = 0U;
+  }
+  size_t maxIdx = 0, minIdx = 0;
+  for (size_t i = 1; i < N; i++) {
+    maxIdx = uint256_cmp(vals[i], vals[maxIdx]) > 0 ? i : maxIdx;
+    minIdx = uint256_cmp(vals[i], vals[minIdx]) < 0 ? i : minIdx;
+  }
+  ASSERT(maxIdx == uint256_max_index(vals, N));
+  ASSERT(minIdx == uint256_min_index(vals, N));
+
+  // ties across lanes and blocks go to the first occurrence
+  set_all(&vals[70], 0U);
+  vals[70].data[6] = 7U;
+  vals[37] = vals[70];
+  vals[14] = vals[70];
+  ASSERT(14 == uint256_max_index(vals, N));
+  set_all(&vals[45], 0U);
+  vals[202] = vals[45];
+  vals[3] = vals[45];
+  ASSERT(3 == uint256_min_index(vals, N));
+
+  // a winner past the last full block
+  vals[201].data[6] = 8U;
+  ASSERT(201 == uint256_max_index(vals, N));
+}
+
+// sorting enough values to take the radix passes, with duplicates
+void test_sort() {
+  enum { N = 1000 };
+  static UInt256 vals[N], copy[N];
+  uint32_t x = 12345U;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < 8; j++) {
+      x = x * 1103515245U + 12345U;
+      // few distinct top bytes, so buckets need further passes
+      vals[i].data[j] = (j == 7) ? (x >> 28) << 24 : x;
+    }
+  }
+  vals[10] = vals[20];
+  memcpy(copy, vals, sizeof(vals));
+
+  uint256_sort(vals, N);
+  for (int i = 1; i < N; i++) {
+    ASSERT(uint256_cmp(vals[i - 1], vals[i]) <= 0);
+  }
+
+  ASSERT(uint256_sort_parallel(copy, N, 4) > 1);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(vals[i], copy[i]);
+  }
+
+  // tiny inputs
+  uint256_sort(vals, 0);
+  UInt256 two[2] = {{{2}}, {{1}}};
+  uint256_sort(two, 2);
+  ASSERT(1U == two[0].data[0] && 2U == two[1].data[0]);
+}
+
+// values below 2^40 share their top 27 bytes; the parallel sort must
+// still split them into many buckets rather than one
+void test_sort_parallel_shared_top_bytes() {
+  enum { N = 1000 };
+  static UInt256 vals[N], copy[N];
+  uint32_t x = 12345U;
+  for (int i = 0; i < N; i++) {
+    set_all(&vals[i], 0U);
+    x = x * 1103515245U + 12345U;
+    vals[i].data[0] = x;
+    x = x * 1103515245U + 12345U;
+    vals[i].data[1] = x >> 24;
+  }
+  memcpy(copy, vals, sizeof(vals));
+
+  uint256_sort(vals, N);
+  ASSERT(uint256_sort_parallel(copy, N, 4) > 100);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(vals[i], copy[i]);
+  }
+
+  // all equal: nothing to split
+  for (int i = 0; i < N; i++) {
+    copy[i] = vals[0];
+  }
+  ASSERT(1 == uint256_sort_parallel(copy, N, 4));
+  ASSERT_SAME(vals[0], copy[N - 1]);
+}
+
+// lower bounds agree between the sorted array and the Eytzinger layout
+void test_lower_bound_and_eytzinger() {
+  enum { N = 10 };
+  UInt256 sorted[N], tree[N];
+  for (int i = 0; i < N; i++) {
+    sorted[i] = uint256_create_from_u32((uint32_t)(10 * (i / 2)));  // 0 0 10 10 20 ...
+  }
+  sorted[N - 1].data[7] = 1U;
+  uint256_eytzinger_build(tree, sorted, N);
+  // the root's left subtree holds nodes 2, 4, 5, 8, 9 and 10
+  ASSERT_SAME(sorted[6], tree[0]);
+
+  for (uint32_t k = 0; k <= 45; k++) {
+    UInt256 key = uint256_create_from_u32(k);
+    size_t expected = 0;
+    while (expected < N && uint256_lt(sorted[expected], key)) {
+      expected++;
+    }
+    ASSERT(expected == uint256_lower_bound(sorted, N, key));
+    size_t idx = uint256_eytzinger_lower_bound(tree, N, key);
+    ASSERT(idx < N);
+    ASSERT_SAME(sorted[expected], tree[idx]);
+  }
+
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  ASSERT(N == uint256_lower_bound(sorted, N, max));
+  ASSERT(N == uint256_eytzinger_lower_bound(tree, N, max));
+  ASSERT(0 == uint256_lower_bound(sorted, 0, max));
+  ASSERT(0 == uint256_eytzinger_lower_bound(tree, 0, max));
+}
+
+// equal values hash equally, and one-bit changes move the hash a lot
+void test_hash() {
+  UInt256 val = uint256_create_from_hex("1234567890abcdef1234567890abcdef1234567890abcdef1234567890abcdef");
+  UInt256 same = val;
+  ASSERT(uint256_hash(val) == uint256_hash(same));
+
+  for (unsigned bit = 0; bit < 256; bit += 17) {
+    UInt256 flipped = val;
+    flipped.data[bit / 32] ^= 1U << (bit % 32);
+    uint64_t diff = uint256_hash(val) ^ uint256_hash(flipped);
+    int changed = 0;
+    for (; diff != 0; diff &= diff - 1) {
+      changed++;
+    }
+    ASSERT(changed > 10 && changed < 54);
+  }
+}
+
+// inserting, replacing, growing and removing entries
+void test_map_put_get_remove() {
+  UInt256Map map;
+  ASSERT(uint256_map_init(&map, 0));
+  uint64_t value = 0;
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    UInt256 key = {0};
+    key.data[7] = i;
+    ASSERT(uint256_map_put(&map, key, i * 3U));
+  }
+  ASSERT(1000 == map.size);
+  ASSERT(map.capacity >= 1000);
+
+  UInt256 key = {0};
+  key.data[7] = 500U;
+  ASSERT(uint256_map_get(&map, key, &value));
+  ASSERT(1500U == value);
+  ASSERT(uint256_map_put(&map, key, 7U));
+  ASSERT(uint256_map_get(&map, key, &value));
+  ASSERT(7U == value);
+  ASSERT(1000 == map.size);
+
+  ASSERT(uint256_map_remove(&map, key));
+  ASSERT(!uint256_map_remove(&map, key));
+  ASSERT(!uint256_map_get(&map, key, NULL));
+  ASSERT(999 == map.size);
+
+  key.data[7] = 999U;
+  ASSERT(uint256_map_get(&map, key, NULL));
+  key.data[7] = 1000U;
+  ASSERT(!uint256_map_get(&map, key, &value));
+
+  uint256_map_destroy(&map);
+
+  // sizes whose arrays couldn't be addressed fail instead of wrapping
+  ASSERT(!uint256_map_init(&map, SIZE_MAX));
+  ASSERT(!uint256_map_init(&map, SIZE_MAX / sizeof(UInt256)));
+}
+
+// bitwise operations on values with bits in every word
+void test_bitwise() {
+  UInt256 left = uint256_create_from_hex("ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00");
+  UInt256 right = uint256_create_from_hex("0ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff0");
+
+  ASSERT_SAME(uint256_create_from_hex("0f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000f00"),
+              uint256_and(left, right));
+  ASSERT_SAME(uint256_create_from_hex("fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0"),
+              uint256_or(left, right));
+  ASSERT_SAME(uint256_create_from_hex("f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0"),
+              uint256_xor(left, right));
+  ASSERT_SAME(uint256_create_from_hex("f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000"),
+              uint256_andnot(left, right));
+  ASSERT_SAME(uint256_create_from_hex("00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff"),
+              uint256_not(left));
+}
+
+// batch bitwise operations match the single-value ones
+void test_bitwise_batch() {
+  enum { N = 37 };
+  UInt256 left[N], right[N], out[N];
+  uint32_t x = 99U;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < 8; j++) {
+      x = x * 1664525U + 1013904223U;
+      left[i].data[j] = x;
+      x = x * 1664525U + 1013904223U;
+      right[i].data[j] = x;
+    }
+  }
+
+  uint256_and_batch(out, left, right, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(uint256_and(left[i], right[i]), out[i]);
+  }
+  uint256_or_batch(out, left, right, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(uint256_or(left[i], right[i]), out[i]);
+  }
+  uint256_xor_batch(out, left, right, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(uint256_xor(left[i], right[i]), out[i]);
+  }
+  uint256_andnot_batch(out, left, right, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(uint256_andnot(left[i], right[i]), out[i]);
+  }
+  uint256_not_batch(out, left, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(uint256_not(left[i]), out[i]);
+  }
+
+  // in place: x ^ y ^ y == x
+  uint256_xor_batch(out, left, right, N);
+  uint256_xor_batch(out, out, right, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT_SAME(left[i], out[i]);
+  }
+}
+
+// leading/trailing zero counts, popcount and bit length
+void test_bit_counts() {
+  UInt256 zero = {0};
+  ASSERT(256 == uint256_clz(zero));
+  ASSERT(256 == uint256_ctz(zero));
+  ASSERT(0 == uint256_popcount(zero));
+  ASSERT(0 == uint256_bit_length(zero));
+
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  ASSERT(0 == uint256_clz(max));
+  ASSERT(0 == uint256_ctz(max));
+  ASSERT(256 == uint256_popcount(max));
+  ASSERT(256 == uint256_bit_length(max));
+
+  UInt256 val = uint256_create_from_hex("1800000000000000000000000000000000000000000000000000000000000000");
+  ASSERT(3 == uint256_clz(val));
+  ASSERT(251 == uint256_ctz(val));
+  ASSERT(2 == uint256_popcount(val));
+  ASSERT(253 == uint256_bit_length(val));
+
+  val = uint256_create_from_hex("10000000000000000");
+  ASSERT(191 == uint256_clz(val));
+  ASSERT(64 == uint256_ctz(val));
+  ASSERT(65 == uint256_bit_length(val));
+}
+
+// single bits and bit fields, including fields that straddle limbs
+void test_test_and_extract_bits() {
+  UInt256 val = uint256_create_from_hex("8000000000000000fedcba9876543210fedcba98765432100123456789abcdef");
+
+  ASSERT(1 == uint256_test_bit(val, 0));
+  ASSERT(0 == uint256_test_bit(val, 4));
+  ASSERT(1 == uint256_test_bit(val, 255));
+  ASSERT(0 == uint256_test_bit(val, 256));
+
+  ASSERT(0xfU == uint256_extract_bits(val, 0, 4));
+  ASSERT(0x0123456789abcdefULL == uint256_extract_bits(val, 0, 64));
+  ASSERT(0x765432100123ULL == uint256_extract_bits(val, 48, 48));
+  ASSERT(0x8000000000000000ULL == uint256_extract_bits(val, 192, 64));
+  // bits past the top read as zero
+  ASSERT(0x4ULL == uint256_extract_bits(val, 253, 64));
+  ASSERT(0 == uint256_extract_bits(val, 256, 8));
+  // out-of-range widths
+  ASSERT(0 == uint256_extract_bits(val, 0, 0));
+  ASSERT(0x0123456789abcdefULL == uint256_extract_bits(val, 0, 65));
+  ASSERT(0x0123456789abcdefULL == uint256_extract_bits(val, 0, 1000));
+}
+
+// division by powers of two, which shifts and masks
+void test_divmod_power_of_two() {
+  UInt256 num = uint256_create_from_hex("fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210");
+  UInt256 den = {0};
+  den.data[3] = 0x10U;  // 2^100
+  UInt256 quot, rem;
+
+  uint256_divmod(num, den, &quot, &rem);
+  ASSERT_SAME(uint256_shr(num, 100), quot);
+  ASSERT_SAME(uint256_create_from_hex("876543210fedcba9876543210"), rem);
+
+  uint256_divmod(num, uint256_create_from_u32(1U), &quot, &rem);
+  ASSERT_SAME(num, quot);
+  ASSERT_SAME(uint256_create_from_u32(0U), rem);
+}
+
+// constant-time operations with fixed and with random secret inputs
+void test_ct_select_cswap() {
+  UInt256 a = uint256_create_from_hex("1111111111111111111111111111111111111111111111111111111111111111");
+  UInt256 b = uint256_create_from_hex("2222222222222222222222222222222222222222222222222222222222222222");
+
+  ASSERT_SAME(a, uint256_ct_select(1U, a, b));
+  ASSERT_SAME(a, uint256_ct_select(0x80000000U, a, b));
+  ASSERT_SAME(b, uint256_ct_select(0U, a, b));
+
+  UInt256 x = a, y = b;
+  uint256_ct_cswap(0U, &x, &y);
+  ASSERT_SAME(a, x);
+  ASSERT_SAME(b, y);
+  uint256_ct_cswap(1U, &x, &y);
+  ASSERT_SAME(b, x);
+  ASSERT_SAME(a, y);
+}
+
+// constant-time arithmetic agrees with the regular operations
+void test_ct_arithmetic() {
+  UInt256 zero = {0};
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 one = uint256_create_from_u32(1U);
+  UInt256 val = uint256_create_from_hex("0123456789abcdeffedcba987654321000112233445566778899aabbccddeeff");
+
+  ASSERT_SAME(zero, uint256_ct_add(max, one));
+  ASSERT_SAME(uint256_create_from_u32(2U), uint256_ct_sub(one, max));
+  ASSERT_SAME(max, uint256_ct_negate(one));
+  ASSERT_SAME(zero, uint256_ct_negate(zero));
+  ASSERT_SAME(uint256_create_from_hex("fedcba98765432100123456789abcdefffeeddccbbaa99887766554433221101"), uint256_ct_negate(val));
+
+  UInt256 left1 = uint256_create_from_hex("02468acf13579bdffdb97530eca864200022446688aaccef1133557799bbddfe");
+  UInt256 right1 = uint256_create_from_hex("8091a2b3c4d5e6f7ff6e5d4c3b2a190800089119a22ab33bc44cd55de66ef77f");
+  ASSERT_SAME(val, uint256_ct_rotate_left(val, 0));
+  ASSERT_SAME(val, uint256_ct_rotate_right(val, 0));
+  ASSERT_SAME(left1, uint256_ct_rotate_left(val, 1));
+  ASSERT_SAME(right1, uint256_ct_rotate_right(val, 1));
+  ASSERT_SAME(uint256_create_from_hex("fedcba987654321000112233445566778899aabbccddeeff0123456789abcdef"), uint256_ct_rotate_left(val, 64));
+  ASSERT_SAME(uint256_create_from_hex("8899aabbccddeeff0123456789abcdeffedcba98765432100011223344556677"), uint256_ct_rotate_right(val, 64));
+  ASSERT_SAME(right1, uint256_ct_rotate_left(val, 255));
+  ASSERT_SAME(left1, uint256_ct_rotate_right(val, 255));
+  // counts of 256 or more wrap around
+  ASSERT_SAME(val, uint256_ct_rotate_left(val, 256));
+  ASSERT_SAME(val, uint256_ct_rotate_right(val, 256));
+  ASSERT_SAME(uint256_create_from_hex("bcdeffedcba987654321000112233445566778899aabbccddeeff0123456789a"), uint256_ct_rotate_left(val, 300));
+  ASSERT_SAME(uint256_create_from_hex("abbccddeeff0123456789abcdeffedcba987654321000112233445566778899a"), uint256_ct_rotate_right(val, 300));
+}
+
+// dudect-style timing check of the uint256_ct_* operations: the mean
+// time for all-zero inputs must not differ detectably from random ones
+void test_ct_timing() {
+  for (int op = 0; op < CT_NUM_OPS; op++) {
+    double t = ct_timing_t(op);
+    ASSERT(fabs(t) < 10.0);
+  }
+}
+
+// greatest common divisors, including zero and shared powers of two
+void test_gcd() {
+  UInt256 zero = {0};
+  UInt256 a = uint256_create_from_hex("1e6c8a3b7f2d4e5a9c0b1d2e3f40516273849507");
+  ASSERT_SAME(a, uint256_gcd(a, zero));
+  ASSERT_SAME(a, uint256_gcd(zero, a));
+  ASSERT_SAME(zero, uint256_gcd(zero, zero));
+  ASSERT_SAME(uint256_create_from_u32(6U), uint256_gcd(uint256_create_from_u32(48U), uint256_create_from_u32(18U)));
+
+  // gcd(a * 2^40, a * 3 * 2^70) = a * 2^40, for odd a
+  UInt256 left = uint256_shl(a, 40);
+  UInt256 right = uint256_shl(uint256_mul(a, uint256_create_from_u32(3U)), 70);
+  ASSERT_SAME(uint256_shl(a, 40), uint256_gcd(left, right));
+}
+
+// inverses for odd and even moduli, and values with no inverse
+void test_modinv() {
+  UInt256 zero = {0};
+  UInt256 one = uint256_create_from_u32(1U);
+  UInt256 p = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f");
+  UInt256 val = uint256_create_from_hex("123456789abcdef0fedcba98765432100123456789abcdef0fedcba987654321");
+
+  UInt256 inv = uint256_modinv(val, p);
+  ASSERT_SAME(uint256_create_from_hex("3ee9c07975e3844e62d748433c0052e7e3d4be54c521c672203141dee9c391bc"), inv);
+  ASSERT_SAME(one, uint256_mulmod(val, inv, p));
+  ASSERT_SAME(inv, uint256_ct_modinv(val, p));
+  ASSERT_SAME(inv, uint256_fp_k1_inv(val));
+  ASSERT_SAME(uint256_sub(p, one), uint256_modinv(uint256_sub(p, one), p));
+
+  // even modulus
+  UInt256 m = uint256_create_from_hex("fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe");
+  inv = uint256_modinv(val, m);
+  ASSERT_SAME(one, uint256_mulmod(val, inv, m));
+  ASSERT_SAME(zero, uint256_modinv(uint256_create_from_u32(6U), m));
+  ASSERT_SAME(uint256_create_from_u32(4U), uint256_modinv(uint256_create_from_u32(7U), uint256_create_from_u32(9U)));
+
+  ASSERT_SAME(zero, uint256_modinv(zero, p));
+  ASSERT_SAME(zero, uint256_ct_modinv(zero, p));
+  ASSERT_SAME(zero, uint256_modinv(val, zero));
+  ASSERT_SAME(zero, uint256_modinv(uint256_create_from_u32(6U), uint256_create_from_u32(9U)));
+  ASSERT_SAME(zero, uint256_ct_modinv(uint256_create_from_u32(6U), uint256_create_from_u32(9U)));
+  ASSERT_SAME(zero, uint256_ct_modinv(val, m));
+}
+
+// batch inversion matches one inversion per value
+void test_modinv_batch() {
+  UInt256 p = uint256_create_from_hex("ffffffff00000001000000000000000000000000ffffffffffffffffffffffff");
+  UInt256 vals[5], out[5];
+  for (int i = 0; i < 5; i++) {
+    vals[i] = uint256_create_from_hex("fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210");
+    vals[i].data[0] += (uint32_t)i;
+  }
+  ASSERT(1 == uint256_modinv_batch(out, vals, 5, p));
+  for (int i = 0; i < 5; i++) {
+    ASSERT_SAME(uint256_modinv(vals[i], p), out[i]);
+  }
+
+  // a zero anywhere means no inverse for the product
+  vals[3] = uint256_create_from_u32(0U);
+  ASSERT(0 == uint256_modinv_batch(out, vals, 5, p));
+  for (int i = 0; i < 5; i++) {
+    ASSERT_SAME(vals[3], out[i]);
+  }
+}
+
+// integer square roots of small, large and maximal values
+void test_isqrt() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  ASSERT_SAME(uint256_create_from_u32(0U), uint256_isqrt(uint256_create_from_u32(0U)));
+  ASSERT_SAME(uint256_create_from_u32(1U), uint256_isqrt(uint256_create_from_u32(3U)));
+  ASSERT_SAME(uint256_create_from_u32(2U), uint256_isqrt(uint256_create_from_u32(4U)));
+  ASSERT_SAME(uint256_create_from_u32(65535U), uint256_isqrt(uint256_create_from_u32(0xFFFFFFFFU)));
+  ASSERT_SAME(uint256_create_from_hex("ffffffffffffffffffffffffffffffff"), uint256_isqrt(max));
+  ASSERT_SAME(uint256_create_from_hex("ff6e33c7bdd7c558b6974399ae628932"),
+              uint256_isqrt(uint256_create_from_hex("fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210")));
+
+  // just below and at a large perfect square
+  UInt256 root = uint256_create_from_hex("1234567890abcdef1234567890abcdef");
+  UInt256 square = uint256_mul(root, root);
+  ASSERT_SAME(root, uint256_isqrt(square));
+  ASSERT_SAME(uint256_sub(root, uint256_create_from_u32(1U)), uint256_isqrt(uint256_sub(square, uint256_create_from_u32(1U))));
+}
+
+// perfect squares are recognized, near misses are rejected
+void test_is_square() {
+  UInt256 root = uint256_create_from_hex("1234567890abcdef1234567890abcdef");
+  UInt256 square = uint256_create_from_hex("14b66dc328828bca8de2cc20802f69a4dda24ef786d72fea6475f09a2f2a521");
+  UInt256 out = {0};
+
+  ASSERT(1 == uint256_is_square(square, &out));
+  ASSERT_SAME(root, out);
+  ASSERT(1 == uint256_is_square(square, NULL));
+  ASSERT(0 == uint256_is_square(uint256_add(square, uint256_create_from_u32(1U)), NULL));
+  ASSERT(0 == uint256_is_square(uint256_add(square, uint256_shl(root, 1)), NULL));
+  ASSERT(1 == uint256_is_square(uint256_create_from_u32(0U), NULL));
+  ASSERT(0 == uint256_is_square(uint256_create_from_u32(2U), NULL));
+
+  // the residue filters must not reject any square
+  for (uint32_t i = 0; i < 2000; i++) {
+    ASSERT(1 == uint256_is_square(uint256_create_from_u32(i * i), &out));
+    ASSERT_SAME(uint256_create_from_u32(i), out);
+  }
+}
+
+// Small values and two's complement negatives for the EVM tests
+#define U(x) uint256_create_from_u32(x)
+#define NEG(x) uint256_negate(uint256_create_from_u32(x))
+
+// unsigned EVM arithmetic, using the examples from evm.codes
+void test_evm_arithmetic() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 big = uint256_create_from_hex("fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210");
+
+  ASSERT_SAME(U(1U), uint256_evm_div(U(10U), U(10U)));
+  ASSERT_SAME(U(0U), uint256_evm_div(U(1U), U(2U)));
+  ASSERT_SAME(U(0U), uint256_evm_div(big, U(0U)));
+  ASSERT_SAME(uint256_div(big, U(7U)), uint256_evm_div(big, U(7U)));
+  ASSERT_SAME(U(1U), uint256_evm_mod(U(10U), U(3U)));
+  ASSERT_SAME(U(2U), uint256_evm_mod(U(17U), U(5U)));
+  ASSERT_SAME(U(0U), uint256_evm_mod(big, U(0U)));
+
+  ASSERT_SAME(U(4U), uint256_evm_addmod(U(10U), U(10U), U(8U)));
+  ASSERT_SAME(U(1U), uint256_evm_addmod(max, U(2U), U(2U)));
+  ASSERT_SAME(U(0U), uint256_evm_addmod(max, max, U(0U)));
+  ASSERT_SAME(U(4U), uint256_evm_mulmod(U(10U), U(10U), U(8U)));
+  ASSERT_SAME(U(9U), uint256_evm_mulmod(max, max, U(12U)));
+  ASSERT_SAME(U(0U), uint256_evm_mulmod(max, max, U(0U)));
+
+  ASSERT_SAME(U(100U), uint256_evm_exp(U(10U), U(2U)));
+  ASSERT_SAME(U(4U), uint256_evm_exp(U(2U), U(2U)));
+  ASSERT_SAME(U(1U), uint256_evm_exp(big, U(0U)));
+  ASSERT_SAME(U(0U), uint256_evm_exp(U(2U), U(256U)));
+  ASSERT_SAME(uint256_shl(U(1U), 255), uint256_evm_exp(U(2U), U(255U)));
+  ASSERT_SAME(max, uint256_evm_exp(max, max));
+  ASSERT_SAME(uint256_create_from_hex("aa832264686eb65ceaca2ed3d9a3b695e33b0553bf4629cc93d5a5e419561000"),
+              uint256_evm_exp(big, U(3U)));
+}
+
+// signed division and remainder truncate toward zero
+void test_evm_signed_arithmetic() {
+  UInt256 minInt = uint256_shl(U(1U), 255);
+
+  ASSERT_SAME(U(1U), uint256_evm_sdiv(U(10U), U(10U)));
+  ASSERT_SAME(U(2U), uint256_evm_sdiv(NEG(2U), NEG(1U)));
+  ASSERT_SAME(NEG(3U), uint256_evm_sdiv(NEG(7U), U(2U)));
+  ASSERT_SAME(NEG(3U), uint256_evm_sdiv(U(7U), NEG(2U)));
+  ASSERT_SAME(minInt, uint256_evm_sdiv(minInt, NEG(1U)));
+  ASSERT_SAME(U(0U), uint256_evm_sdiv(NEG(7U), U(0U)));
+
+  ASSERT_SAME(U(1U), uint256_evm_smod(U(10U), U(3U)));
+  ASSERT_SAME(NEG(2U), uint256_evm_smod(NEG(8U), NEG(3U)));
+  ASSERT_SAME(NEG(1U), uint256_evm_smod(NEG(7U), U(2U)));
+  ASSERT_SAME(U(1U), uint256_evm_smod(U(7U), NEG(2U)));
+  ASSERT_SAME(U(0U), uint256_evm_smod(minInt, NEG(1U)));
+  ASSERT_SAME(U(0U), uint256_evm_smod(NEG(7U), U(0U)));
+}
+
+// SIGNEXTEND, BYTE and the shifts, including out-of-range operands
+void test_evm_bytes_and_shifts() {
+  UInt256 max;
+  set_all(&max, 0xFFFFFFFFU);
+  UInt256 huge = uint256_shl(U(1U), 200);
+
+  ASSERT_SAME(max, uint256_evm_signextend(U(0U), U(0xFFU)));
+  ASSERT_SAME(U(0x7FU), uint256_evm_signextend(U(0U), U(0x7FU)));
+  ASSERT_SAME(NEG(0x7100U), uint256_evm_signextend(U(1U), U(0x8F00U)));
+  ASSERT_SAME(U(0x1234U), uint256_evm_signextend(U(1U), U(0xAB1234U)));
+  ASSERT_SAME(U(0xFFU), uint256_evm_signextend(U(31U), U(0xFFU)));
+  ASSERT_SAME(U(0xFFU), uint256_evm_signextend(huge, U(0xFFU)));
+
+  ASSERT_SAME(U(0xFFU), uint256_evm_byte(U(31U), U(0xFFU)));
+  ASSERT_SAME(U(0xFFU), uint256_evm_byte(U(30U), U(0xFF00U)));
+  ASSERT_SAME(U(0xFEU), uint256_evm_byte(U(0U), uint256_create_from_hex("fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210")));
+  ASSERT_SAME(U(0U), uint256_evm_byte(U(32U), max));
+  ASSERT_SAME(U(0U), uint256_evm_byte(huge, max));
+
+  ASSERT_SAME(U(2U), uint256_evm_shl(U(1U), U(1U)));
+  ASSERT_SAME(uint256_create_from_hex("f000000000000000000000000000000000000000000000000000000000000000"),
+              uint256_evm_shl(U(4U), uint256_create_from_hex("ff00000000000000000000000000000000000000000000000000000000000000")));
+  ASSERT_SAME(U(0U), uint256_evm_shl(U(256U), max));
+  ASSERT_SAME(U(1U), uint256_evm_shr(U(1U), U(2U)));
+  ASSERT_SAME(U(0xFU), uint256_evm_shr(U(4U), U(0xFFU)));
+  ASSERT_SAME(U(0U), uint256_evm_shr(huge, max));
+  ASSERT_SAME(U(1U), uint256_evm_sar(U(1U), U(2U)));
+  ASSERT_SAME(max, uint256_evm_sar(U(4U), NEG(0x10U)));
+  ASSERT_SAME(NEG(2U), uint256_evm_sar(U(2U), NEG(8U)));
+  ASSERT_SAME(max, uint256_evm_sar(huge, NEG(1U)));
+  ASSERT_SAME(U(0U), uint256_evm_sar(U(256U), U(0x7FU)));
+}
+
+// signed comparisons order negatives below zero
+void test_evm_signed_compare() {
+  UInt256 minInt = uint256_shl(U(1U), 255);
+  UInt256 maxInt = uint256_sub(minInt, U(1U));
+
+  ASSERT_SAME(U(1U), uint256_evm_slt(U(9U), U(10U)));
+  ASSERT_SAME(U(1U), uint256_evm_slt(NEG(1U), U(0U)));
+  ASSERT_SAME(U(0U), uint256_evm_slt(U(0U), NEG(1U)));
+  ASSERT_SAME(U(0U), uint256_evm_slt(U(5U), U(5U)));
+  ASSERT_SAME(U(1U), uint256_evm_slt(minInt, maxInt));
+  ASSERT_SAME(U(1U), uint256_evm_sgt(U(10U), U(9U)));
+  ASSERT_SAME(U(1U), uint256_evm_sgt(U(0U), NEG(1U)));
+  ASSERT_SAME(U(0U), uint256_evm_sgt(minInt, maxInt));
+  ASSERT_SAME(U(0U), uint256_evm_sgt(NEG(3U), NEG(3U)));
+}